@@ -20,9 +20,534 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+// ===== FUNCIONES AUXILIARES DE ISBN =====
+
+// Dígito de control de un ISBN-13 a partir de sus 12 primeros dígitos
+inline int digitoControlISBN13(uint64_t cuerpo) {
+    int suma = 0;
+    for (int i = 0; i < 12; i++) {
+        int peso = (i % 2 == 0) ? 3 : 1; // Se recorre desde el último dígito
+        suma += static_cast<int>(cuerpo % 10) * peso;
+        cuerpo /= 10;
+    }
+    return (10 - suma % 10) % 10;
+}
+
+// Convierte un ISBN (con o sin guiones, ISBN-10 o ISBN-13) en una clave
+// entera de 64 bits con los 13 dígitos del ISBN-13. Devuelve 0 si no es
+// válido; con validarControl también se rechazan dígitos de control erróneos.
+uint64_t normalizarISBN(const char* isbn, size_t longitud, bool validarControl) {
+    uint64_t clave = 0;
+    int digitos = 0;
+    int sumaISBN10 = 0; // Suma ponderada del ISBN-10 (pesos 10..1)
+    bool terminaEnX = false;
+    for (size_t i = 0; i < longitud; i++) {
+        char c = isbn[i];
+        if (c == '-' || c == ' ') {
+            continue;
+        }
+        if (terminaEnX) {
+            return 0; // La 'X' solo puede ser el último carácter
+        }
+        if (c >= '0' && c <= '9') {
+            clave = clave * 10 + static_cast<uint64_t>(c - '0');
+            sumaISBN10 += (10 - digitos) * (c - '0');
+            digitos++;
+        } else if ((c == 'X' || c == 'x') && digitos == 9) {
+            terminaEnX = true;
+            sumaISBN10 += 10;
+            digitos++;
+        } else {
+            return 0;
+        }
+        if (digitos > 13) {
+            return 0;
+        }
+    }
+
+    if (digitos == 13 && !terminaEnX) {
+        if (validarControl && digitoControlISBN13(clave / 10) != static_cast<int>(clave % 10)) {
+            return 0;
+        }
+        return clave;
+    }
+    if (digitos != 10 || (validarControl && sumaISBN10 % 11 != 0)) {
+        return 0;
+    }
+
+    // ISBN-10: se descarta el dígito de control, se antepone 978
+    // y se recalcula el dígito de control del ISBN-13
+    uint64_t cuerpo = 978000000000ULL + (terminaEnX ? clave : clave / 10);
+    return cuerpo * 10 + static_cast<uint64_t>(digitoControlISBN13(cuerpo));
+}
+
+uint64_t normalizarISBN(const string& isbn, bool validarControl = false) {
+    return normalizarISBN(isbn.data(), isbn.size(), validarControl);
+}
+
+// ===== FUNCIONES AUXILIARES DE BITS =====
+
+// Cuenta los bits a 1 de una palabra de 64 bits (popcount)
+inline int contarBits(uint64_t palabra) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(palabra);
+#else
+    int total = 0;
+    while (palabra) {
+        palabra &= palabra - 1;
+        total++;
+    }
+    return total;
+#endif
+}
+
+// Posición del bit a 1 menos significativo (palabra debe ser distinta de 0)
+inline int primerBit(uint64_t palabra) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(palabra);
+#else
+    int pos = 0;
+    while (!(palabra & 1)) {
+        palabra >>= 1;
+        pos++;
+    }
+    return pos;
+#endif
+}
+
+// ===== FUNCIONES AUXILIARES DE ARCHIVOS BINARIOS =====
+// Los archivos binarios (snapshot y WAL) usan la representación nativa de
+// la máquina: sirven para reiniciar en el mismo equipo, no para intercambio.
+
+template <typename T>
+void escribirValor(FILE* archivo, const T& valor) {
+    fwrite(&valor, sizeof(T), 1, archivo);
+}
+
+template <typename T>
+void escribirVector(FILE* archivo, const vector<T>& v) {
+    escribirValor<uint64_t>(archivo, v.size());
+    if (!v.empty()) {
+        fwrite(v.data(), sizeof(T), v.size(), archivo);
+    }
+}
+
+inline void escribirTexto(FILE* archivo, const string& texto) {
+    escribirValor<uint64_t>(archivo, texto.size());
+    fwrite(texto.data(), 1, texto.size(), archivo);
+}
+
+// Fuerza que los datos escritos lleguen al disco
+inline bool sincronizarArchivo(FILE* archivo) {
+    if (fflush(archivo) != 0) {
+        return false;
+    }
+#if defined(_WIN32)
+    return true;
+#else
+    return fsync(fileno(archivo)) == 0;
+#endif
+}
+
+// Lee valores de un bloque de memoria comprobando que no se sale de él
+class LectorBinario {
+private:
+    const char* p;
+    const char* fin;
+
+public:
+    LectorBinario(const char* datos, size_t longitud) : p(datos), fin(datos + longitud) {}
+
+    size_t restantes() const { return static_cast<size_t>(fin - p); }
+
+    template <typename T>
+    bool leer(T& valor) {
+        if (restantes() < sizeof(T)) {
+            return false;
+        }
+        memcpy(&valor, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool leerVector(vector<T>& v) {
+        uint64_t n;
+        if (!leer(n) || n > restantes() / sizeof(T)) {
+            return false;
+        }
+        v.resize(static_cast<size_t>(n));
+        if (n > 0) {
+            memcpy(&v[0], p, static_cast<size_t>(n) * sizeof(T));
+        }
+        p += n * sizeof(T);
+        return true;
+    }
+
+    bool leerBytes(string& texto, size_t n) {
+        if (n > restantes()) {
+            return false;
+        }
+        texto.assign(p, n);
+        p += n;
+        return true;
+    }
+
+    bool leerTexto(string& texto) {
+        uint64_t n;
+        return leer(n) && n <= restantes() && leerBytes(texto, static_cast<size_t>(n));
+    }
+};
+
+// ===== CLASE TABLAHASH =====
+// Índice de direccionamiento abierto (sondeo lineal) que asocia una clave
+// entera con la posición del objeto en su vector
+class TablaHash {
+private:
+    struct Ranura {
+        uint64_t clave;
+        int valor;
+        bool ocupada;
+    };
+
+    vector<Ranura> ranuras;
+    size_t ocupadas;
+
+    // Mezcla los bits de la clave (finalizador de splitmix64)
+    static uint64_t mezclar(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Cambia el número de ranuras (potencia de 2) y reinserta todas las claves
+    void crecer(size_t nuevaCapacidad) {
+        vector<Ranura> anteriores(nuevaCapacidad, Ranura{0, -1, false});
+        anteriores.swap(ranuras);
+        size_t mascara = ranuras.size() - 1;
+        for (const auto& r : anteriores) {
+            if (!r.ocupada) {
+                continue;
+            }
+            size_t i = mezclar(r.clave) & mascara;
+            while (ranuras[i].ocupada) {
+                i = (i + 1) & mascara;
+            }
+            ranuras[i] = r;
+        }
+    }
+
+public:
+    TablaHash() : ranuras(16, Ranura{0, -1, false}), ocupadas(0) {}
+
+    size_t size() const { return ocupadas; }
+
+    // Prepara la tabla para n claves sin volver a crecer (factor de carga <= 0.7)
+    void reservar(size_t n) {
+        size_t capacidad = ranuras.size();
+        while (n * 10 > capacidad * 7) {
+            capacidad *= 2;
+        }
+        if (capacidad != ranuras.size()) {
+            crecer(capacidad);
+        }
+    }
+
+    // Devuelve el valor asociado a la clave o -1 si no existe
+    int buscar(uint64_t clave) const {
+        size_t mascara = ranuras.size() - 1;
+        size_t i = mezclar(clave) & mascara;
+        while (ranuras[i].ocupada) {
+            if (ranuras[i].clave == clave) {
+                return ranuras[i].valor;
+            }
+            i = (i + 1) & mascara;
+        }
+        return -1;
+    }
+
+    // Inserta la clave; devuelve false si ya existía
+    bool insertar(uint64_t clave, int valor) {
+        reservar(ocupadas + 1);
+        size_t mascara = ranuras.size() - 1;
+        size_t i = mezclar(clave) & mascara;
+        while (ranuras[i].ocupada) {
+            if (ranuras[i].clave == clave) {
+                return false;
+            }
+            i = (i + 1) & mascara;
+        }
+        ranuras[i] = Ranura{clave, valor, true};
+        ocupadas++;
+        return true;
+    }
+
+    // Métodos para guardar y recuperar la tabla tal cual (sin reinsertar)
+    void guardar(FILE* archivo) const {
+        escribirValor<uint64_t>(archivo, ocupadas);
+        escribirVector(archivo, ranuras);
+    }
+
+    bool cargar(LectorBinario& lector) {
+        uint64_t n;
+        vector<Ranura> leidas;
+        if (!lector.leer(n) || !lector.leerVector(leidas) ||
+            leidas.empty() || (leidas.size() & (leidas.size() - 1)) != 0) {
+            return false;
+        }
+        ranuras.swap(leidas);
+        ocupadas = static_cast<size_t>(n);
+        return true;
+    }
+};
+
+// ===== CLASE INFORME =====
+// Formatos de salida de los listados
+enum FormatoInforme {
+    INFORME_TEXTO,
+    INFORME_CSV,
+    INFORME_JSON
+};
+
+// Columna de un informe: clave para CSV/JSON y etiqueta para el texto.
+// En texto, una columna entre paréntesis va al final de la línea de la
+// anterior: "Usuario: Ana (ID: 3)".
+struct ColumnaInforme {
+    const char* clave;
+    const char* etiqueta;
+    bool entreParentesis;
+};
+
+// Genera listados en un búfer reservado de antemano y lo escribe de una
+// vez, en lugar de vaciar la salida línea a línea. Cuando el búfer se
+// llena se envía ese trozo y se sigue, así que exportar un catálogo muy
+// grande no necesita tenerlo entero en memoria.
+// Uso: un campo() por columna, en orden, y terminarRegistro() por fila.
+class Informe {
+private:
+    ostream& salida;
+    FormatoInforme formato;
+    const ColumnaInforme* columnas;
+    size_t numColumnas;
+    size_t capacidad;
+    string bufer;
+    size_t columna;   // Columna siguiente dentro del registro actual
+    size_t registros;
+    bool terminado;
+
+    void volcar() {
+        if (!bufer.empty()) {
+            salida.write(bufer.data(), static_cast<streamsize>(bufer.size()));
+            bufer.clear();
+        }
+    }
+
+    // Entre comillas si contiene separadores, comillas o saltos de línea
+    void anadirCSV(const char* texto, size_t longitud) {
+        bool comillas = false;
+        for (size_t i = 0; i < longitud && !comillas; i++) {
+            char c = texto[i];
+            comillas = (c == ',' || c == '"' || c == '\n' || c == '\r');
+        }
+        if (!comillas) {
+            bufer.append(texto, longitud);
+            return;
+        }
+        bufer += '"';
+        for (size_t i = 0; i < longitud; i++) {
+            if (texto[i] == '"') {
+                bufer += '"';
+            }
+            bufer += texto[i];
+        }
+        bufer += '"';
+    }
+
+    // Cadena JSON; los bytes UTF-8 pasan tal cual
+    void anadirJSON(const char* texto, size_t longitud) {
+        bufer += '"';
+        for (size_t i = 0; i < longitud; i++) {
+            unsigned char c = static_cast<unsigned char>(texto[i]);
+            if (c == '"' || c == '\\') {
+                bufer += '\\';
+                bufer += static_cast<char>(c);
+            } else if (c < 0x20) {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                bufer += escape;
+            } else {
+                bufer += static_cast<char>(c);
+            }
+        }
+        bufer += '"';
+    }
+
+    void abrirCampo() {
+        const ColumnaInforme& c = columnas[columna];
+        switch (formato) {
+        case INFORME_TEXTO:
+            if (c.entreParentesis && !bufer.empty() && bufer.back() == '\n') {
+                bufer.back() = ' ';
+                bufer += '(';
+            }
+            bufer += c.etiqueta;
+            bufer += ": ";
+            break;
+        case INFORME_CSV:
+            if (columna > 0) {
+                bufer += ',';
+            }
+            break;
+        case INFORME_JSON:
+            if (columna == 0) {
+                bufer += (registros > 0) ? ",\n  {\"" : "\n  {\"";
+            } else {
+                bufer += ", \"";
+            }
+            bufer += c.clave;
+            bufer += "\": ";
+            break;
+        }
+    }
+
+    void cerrarCampo() {
+        if (formato == INFORME_TEXTO) {
+            if (columnas[columna].entreParentesis) {
+                bufer += ')';
+            }
+            bufer += '\n';
+        }
+        columna++;
+    }
+
+public:
+    // Constructor; en CSV escribe la fila de cabecera
+    Informe(ostream& s, FormatoInforme f, const ColumnaInforme* c, size_t n,
+            size_t cap = 64 * 1024)
+        : salida(s), formato(f), columnas(c), numColumnas(n), capacidad(cap),
+          columna(0), registros(0), terminado(false) {
+        bufer.reserve(capacidad + min<size_t>(capacidad, 1024));
+        if (formato == INFORME_CSV) {
+            for (size_t i = 0; i < numColumnas; i++) {
+                if (i > 0) {
+                    bufer += ',';
+                }
+                bufer += columnas[i].clave;
+            }
+            bufer += '\n';
+        } else if (formato == INFORME_JSON) {
+            bufer += '[';
+        }
+    }
+
+    ~Informe() { terminar(); }
+
+    Informe(const Informe&) = delete;
+    Informe& operator=(const Informe&) = delete;
+
+    // Campo de texto; en formato texto los campos vacíos se omiten
+    void campo(const char* texto, size_t longitud) {
+        if (formato == INFORME_TEXTO && longitud == 0) {
+            columna++;
+            return;
+        }
+        abrirCampo();
+        switch (formato) {
+        case INFORME_TEXTO: bufer.append(texto, longitud); break;
+        case INFORME_CSV:   anadirCSV(texto, longitud);    break;
+        case INFORME_JSON:  anadirJSON(texto, longitud);   break;
+        }
+        cerrarCampo();
+    }
+
+    void campo(const string& texto) { campo(texto.data(), texto.size()); }
+
+    // Campo numérico (sin comillas en JSON)
+    void campo(long long numero) {
+        char digitos[24];
+        int longitud = snprintf(digitos, sizeof(digitos), "%lld", numero);
+        abrirCampo();
+        bufer.append(digitos, static_cast<size_t>(longitud));
+        cerrarCampo();
+    }
+
+    // Cierra la fila actual y envía el búfer si ya está lleno
+    void terminarRegistro() {
+        switch (formato) {
+        case INFORME_TEXTO: bufer += "---\n"; break;
+        case INFORME_CSV:   bufer += '\n';    break;
+        case INFORME_JSON:  bufer += '}';     break;
+        }
+        registros++;
+        columna = 0;
+        if (bufer.size() >= capacidad) {
+            volcar();
+        }
+    }
+
+    // Cierra el informe y escribe lo pendiente (también lo hace el destructor)
+    void terminar() {
+        if (terminado) {
+            return;
+        }
+        if (formato == INFORME_JSON) {
+            bufer += (registros > 0) ? "\n]\n" : "]\n";
+        }
+        volcar();
+        salida.flush();
+        terminado = true;
+    }
+
+    size_t getRegistros() const { return registros; }
+};
+
+// Columnas de los listados de libros y de usuarios
+const ColumnaInforme COLUMNAS_LIBRO[] = {
+    {"titulo", "Título", false},
+    {"autor", "Autor", false},
+    {"isbn", "ISBN", false},
+    {"estado", "Estado", false}
+};
+
+const ColumnaInforme COLUMNAS_USUARIO[] = {
+    {"nombre", "Usuario", false},
+    {"id", "ID", true},
+    {"prestados", "Libros prestados", false},
+    {"isbns", "ISBNs", false}
+};
+
+// Capacidad del búfer para mostrar un solo registro
+const size_t CAPACIDAD_REGISTRO = 256;
+
 // ===== CLASE LIBRO =====
 class Libro {
 private:
@@ -36,170 +561,2408 @@ public:
     Libro(string t, string a, string i) 
         : titulo(t), autor(a), isbn(i), disponible(true) {}
 
-    // Getters
-    string getTitulo() const { return titulo; }
-    string getAutor() const { return autor; }
-    string getISBN() const { return isbn; }
-    bool estaDisponible() const { return disponible; }
+    // Getters
+    string getTitulo() const { return titulo; }
+    string getAutor() const { return autor; }
+    string getISBN() const { return isbn; }
+    bool estaDisponible() const { return disponible; }
+
+    // Métodos para cambiar estado
+    void prestar() { disponible = false; }
+    void devolver() { disponible = true; }
+
+    // Método para añadir el libro como una fila de un informe
+    void escribirInforme(Informe& informe) const {
+        informe.campo(titulo);
+        informe.campo(autor);
+        informe.campo(isbn);
+        informe.campo(disponible ? "Disponible" : "Prestado");
+        informe.terminarRegistro();
+    }
+
+    // Método para mostrar información
+    void mostrarInfo() const {
+        Informe informe(cout, INFORME_TEXTO, COLUMNAS_LIBRO, 4, CAPACIDAD_REGISTRO);
+        escribirInforme(informe);
+    }
+};
+
+// ===== CLASE LISTALIBROS =====
+// Manejador de libro: fila del libro en el catálogo
+typedef uint32_t ManejadorLibro;
+
+// Vista de solo lectura sobre una secuencia de manejadores (como un span)
+class VistaLibros {
+private:
+    const ManejadorLibro* datos;
+    size_t tamano;
+
+public:
+    VistaLibros(const ManejadorLibro* d, size_t t) : datos(d), tamano(t) {}
+
+    const ManejadorLibro* begin() const { return datos; }
+    const ManejadorLibro* end() const { return datos + tamano; }
+    size_t size() const { return tamano; }
+    bool empty() const { return tamano == 0; }
+    ManejadorLibro operator[](size_t i) const { return datos[i]; }
+};
+
+// Lista pequeña de manejadores: los primeros EN_LINEA se guardan dentro del
+// propio objeto y solo se reserva memoria si el usuario tiene más libros
+class ListaLibros {
+private:
+    static const uint32_t EN_LINEA = 8;
+
+    ManejadorLibro enLinea[EN_LINEA];
+    ManejadorLibro* datos; // enLinea o memoria del montón
+    uint32_t tamano;
+    uint32_t capacidad;
+
+    ListaLibros(const ListaLibros&);            // No copiable
+    ListaLibros& operator=(const ListaLibros&);
+
+public:
+    ListaLibros() : datos(enLinea), tamano(0), capacidad(EN_LINEA) {}
+
+    ~ListaLibros() {
+        if (datos != enLinea) {
+            delete[] datos;
+        }
+    }
+
+    size_t size() const { return tamano; }
+    VistaLibros vista() const { return VistaLibros(datos, tamano); }
+
+    void agregar(ManejadorLibro libro) {
+        if (tamano == capacidad) {
+            ManejadorLibro* nuevos = new ManejadorLibro[capacidad * 2];
+            copy(datos, datos + tamano, nuevos);
+            if (datos != enLinea) {
+                delete[] datos;
+            }
+            datos = nuevos;
+            capacidad *= 2;
+        }
+        datos[tamano++] = libro;
+    }
+
+    bool contiene(ManejadorLibro libro) const {
+        return find(datos, datos + tamano, libro) != datos + tamano;
+    }
+
+    // Quita el libro intercambiándolo con el último (no conserva el orden)
+    bool quitar(ManejadorLibro libro) {
+        ManejadorLibro* pos = find(datos, datos + tamano, libro);
+        if (pos == datos + tamano) {
+            return false;
+        }
+        *pos = datos[--tamano];
+        return true;
+    }
+};
+
+// ===== CLASE USUARIO =====
+class Usuario {
+private:
+    string nombre;
+    int id;
+    ListaLibros librosPrestados; // Manejadores de los libros prestados
+    mutable mutex cerrojo;       // Protege librosPrestados entre hilos
+
+public:
+    // Constructor
+    Usuario(string n, int i) : nombre(n), id(i) {}
+
+    // Getters
+    const string& getNombre() const { return nombre; }
+    int getId() const { return id; }
+
+    // Vista sin copia de los libros prestados; solo es válida mientras
+    // ningún otro hilo preste o devuelva libros de este usuario
+    VistaLibros getLibrosPrestados() const { return librosPrestados.vista(); }
+
+    // Copia de los libros prestados, segura aunque otros hilos presten
+    vector<ManejadorLibro> copiarLibrosPrestados() const {
+        lock_guard<mutex> guarda(cerrojo);
+        vector<ManejadorLibro> copia;
+        for (ManejadorLibro libro : librosPrestados.vista()) {
+            copia.push_back(libro);
+        }
+        return copia;
+    }
+
+    // Métodos para gestionar préstamos
+    void agregarLibro(ManejadorLibro libro) {
+        lock_guard<mutex> guarda(cerrojo);
+        librosPrestados.agregar(libro);
+    }
+
+    bool tieneLibro(ManejadorLibro libro) const {
+        lock_guard<mutex> guarda(cerrojo);
+        return librosPrestados.contiene(libro);
+    }
+
+    // Devuelve false si el usuario no tenía ese libro
+    bool devolverLibro(ManejadorLibro libro) {
+        lock_guard<mutex> guarda(cerrojo);
+        return librosPrestados.quitar(libro);
+    }
+
+    // Método para añadir el usuario como una fila de un informe;
+    // isbnDe(libro, texto) añade a texto el ISBN de un manejador
+    template <typename Traductor>
+    void escribirInforme(Informe& informe, Traductor isbnDe) const {
+        lock_guard<mutex> guarda(cerrojo);
+        string isbns;
+        for (ManejadorLibro libro : librosPrestados.vista()) {
+            if (!isbns.empty()) {
+                isbns += ' ';
+            }
+            isbnDe(libro, isbns);
+        }
+        informe.campo(nombre);
+        informe.campo(static_cast<long long>(id));
+        informe.campo(static_cast<long long>(librosPrestados.size()));
+        informe.campo(isbns);
+        informe.terminarRegistro();
+    }
+
+    // Método para mostrar información
+    template <typename Traductor>
+    void mostrarInfo(Traductor isbnDe) const {
+        Informe informe(cout, INFORME_TEXTO, COLUMNAS_USUARIO, 4, CAPACIDAD_REGISTRO);
+        escribirInforme(informe, isbnDe);
+    }
+};
+
+// ===== CLASE POOLCADENAS =====
+// Almacena todos los textos en un único bloque contiguo; cada texto
+// distinto se guarda una sola vez y se identifica por un entero
+class PoolCadenas {
+private:
+    string datos;             // Textos concatenados
+    vector<uint32_t> inicios; // Inicio de cada texto (inicios[id + 1] marca el final)
+    vector<int32_t> ranuras;  // Tabla de internado: id del texto o -1
+
+    // Hash FNV-1a de un texto
+    static uint64_t calcularHash(const char* texto, size_t longitud) {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < longitud; i++) {
+            h ^= static_cast<unsigned char>(texto[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    bool esIgual(uint32_t id, const char* texto, size_t longitud) const {
+        return longitud == getLongitud(id) &&
+               datos.compare(inicios[id], longitud, texto, longitud) == 0;
+    }
+
+    void redimensionar(size_t capacidad) {
+        ranuras.assign(capacidad, -1);
+        size_t mascara = capacidad - 1;
+        for (uint32_t id = 0; id < size(); id++) {
+            size_t i = calcularHash(getDatos(id), getLongitud(id)) & mascara;
+            while (ranuras[i] >= 0) {
+                i = (i + 1) & mascara;
+            }
+            ranuras[i] = static_cast<int32_t>(id);
+        }
+    }
+
+public:
+    PoolCadenas() : inicios(1, 0), ranuras(16, -1) {}
+
+    size_t size() const { return inicios.size() - 1; }
+    const char* getDatos(uint32_t id) const { return datos.data() + inicios[id]; }
+    size_t getLongitud(uint32_t id) const { return inicios[id + 1] - inicios[id]; }
+    string obtener(uint32_t id) const { return string(getDatos(id), getLongitud(id)); }
+
+    // Prepara el pool para el número de textos y bytes indicados
+    void reservar(size_t textos, size_t bytes) {
+        datos.reserve(bytes);
+        inicios.reserve(textos + 1);
+        size_t capacidad = ranuras.size();
+        while (textos * 10 > capacidad * 7) {
+            capacidad *= 2;
+        }
+        if (capacidad != ranuras.size()) {
+            redimensionar(capacidad);
+        }
+    }
+
+    // Devuelve el id del texto, añadiéndolo al pool si es la primera vez
+    uint32_t internar(const char* texto, size_t longitud) {
+        size_t mascara = ranuras.size() - 1;
+        size_t i = calcularHash(texto, longitud) & mascara;
+        while (ranuras[i] >= 0) {
+            uint32_t id = static_cast<uint32_t>(ranuras[i]);
+            if (esIgual(id, texto, longitud)) {
+                return id;
+            }
+            i = (i + 1) & mascara;
+        }
+
+        uint32_t id = static_cast<uint32_t>(size());
+        datos.append(texto, longitud);
+        inicios.push_back(static_cast<uint32_t>(datos.size()));
+        ranuras[i] = static_cast<int32_t>(id);
+        if (size() * 10 > ranuras.size() * 7) {
+            redimensionar(ranuras.size() * 2);
+        }
+        return id;
+    }
+
+    uint32_t internar(const string& texto) {
+        return internar(texto.data(), texto.size());
+    }
+
+    // Métodos para guardar y recuperar el pool (incluida la tabla de internado)
+    void guardar(FILE* archivo) const {
+        escribirTexto(archivo, datos);
+        escribirVector(archivo, inicios);
+        escribirVector(archivo, ranuras);
+    }
+
+    bool cargar(LectorBinario& lector) {
+        return lector.leerTexto(datos) && lector.leerVector(inicios) &&
+               lector.leerVector(ranuras) && !inicios.empty() && !ranuras.empty() &&
+               inicios.back() == datos.size();
+    }
+};
+
+// ===== CLASE CATALOGOCOLUMNAR =====
+// Catálogo organizado por columnas (struct-of-arrays): cada atributo de los
+// libros vive en su propio vector contiguo y la disponibilidad en un bitset.
+// El ISBN se guarda dos veces: normalizado, como clave, y tal como se dio
+// (con sus guiones), que es como se muestra.
+// Prestar y devolver son seguros entre hilos (operaciones atómicas sobre el
+// bitset); agregar y reservar no deben coincidir con otros accesos.
+enum FiltroLibros { TODOS, DISPONIBLES, PRESTADOS };
+
+class CatalogoColumnar {
+private:
+    PoolCadenas textos;           // Títulos y autores internados
+    vector<uint32_t> titulos;     // Id del título en el pool
+    vector<uint32_t> autores;     // Id del autor en el pool
+    vector<uint64_t> isbns;       // ISBN-13 normalizado
+    vector<uint32_t> textosISBN;  // Id en el pool del ISBN tal como se dio
+    unique_ptr<atomic<uint64_t>[]> disponibles; // Bit i a 1 si el libro i está disponible
+    size_t capacidadPalabras;
+
+    size_t numPalabras() const { return (size() + 63) / 64; }
+
+    // Amplía el bitset copiando las palabras existentes
+    void asegurarPalabras(size_t palabras) {
+        if (palabras <= capacidadPalabras) {
+            return;
+        }
+        size_t nueva = max(palabras, capacidadPalabras * 2);
+        unique_ptr<atomic<uint64_t>[]> nuevas(new atomic<uint64_t>[nueva]);
+        for (size_t i = 0; i < nueva; i++) {
+            nuevas[i].store(i < capacidadPalabras ? disponibles[i].load() : 0,
+                            memory_order_relaxed);
+        }
+        disponibles.swap(nuevas);
+        capacidadPalabras = nueva;
+    }
+
+    static uint64_t bit(size_t fila) { return 1ULL << (fila % 64); }
+
+public:
+    CatalogoColumnar() : capacidadPalabras(0) {}
+
+    size_t size() const { return isbns.size(); }
+
+    void reservar(size_t libros) {
+        textos.reservar(libros * 3, libros * 48);
+        titulos.reserve(libros);
+        autores.reserve(libros);
+        isbns.reserve(libros);
+        textosISBN.reserve(libros);
+        asegurarPalabras((libros + 63) / 64);
+    }
+
+    // Añade un libro disponible y devuelve su fila
+    size_t agregar(const string& titulo, const string& autor, uint64_t isbn,
+                   const string& textoISBN) {
+        size_t fila = size();
+        titulos.push_back(textos.internar(titulo));
+        autores.push_back(textos.internar(autor));
+        isbns.push_back(isbn);
+        textosISBN.push_back(textos.internar(textoISBN));
+        asegurarPalabras(fila / 64 + 1);
+        disponibles[fila / 64].fetch_or(bit(fila));
+        return fila;
+    }
+
+    // Getters por fila
+    string getTitulo(size_t fila) const { return textos.obtener(titulos[fila]); }
+    string getAutor(size_t fila) const { return textos.obtener(autores[fila]); }
+    uint64_t getISBN(size_t fila) const { return isbns[fila]; }
+    string getTextoISBN(size_t fila) const { return textos.obtener(textosISBN[fila]); }
+    bool estaDisponible(size_t fila) const {
+        return (disponibles[fila / 64].load() & bit(fila)) != 0;
+    }
+
+    // Métodos para cambiar estado: compare-and-swap sobre la palabra del
+    // bitset. Devuelven false (sin escribir) si el libro ya estaba en el
+    // estado pedido, así dos hilos nunca prestan el mismo libro.
+    bool prestar(size_t fila) {
+        atomic<uint64_t>& palabra = disponibles[fila / 64];
+        uint64_t actual = palabra.load();
+        while (actual & bit(fila)) {
+            if (palabra.compare_exchange_weak(actual, actual & ~bit(fila))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool devolver(size_t fila) {
+        atomic<uint64_t>& palabra = disponibles[fila / 64];
+        uint64_t actual = palabra.load();
+        while (!(actual & bit(fila))) {
+            if (palabra.compare_exchange_weak(actual, actual | bit(fila))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Añade el ISBN de una fila, tal como se dio, al final de un texto
+    void anadirISBN(size_t fila, string& destino) const {
+        destino.append(textos.getDatos(textosISBN[fila]), textos.getLongitud(textosISBN[fila]));
+    }
+
+    // Añade una fila del catálogo a un informe sin copiar los textos
+    void escribirInforme(size_t fila, Informe& informe) const {
+        informe.campo(textos.getDatos(titulos[fila]), textos.getLongitud(titulos[fila]));
+        informe.campo(textos.getDatos(autores[fila]), textos.getLongitud(autores[fila]));
+        informe.campo(textos.getDatos(textosISBN[fila]), textos.getLongitud(textosISBN[fila]));
+        informe.campo(estaDisponible(fila) ? "Disponible" : "Prestado");
+        informe.terminarRegistro();
+    }
+
+    // Construye un objeto Libro con los datos de una fila
+    Libro obtenerLibro(size_t fila) const {
+        Libro libro(getTitulo(fila), getAutor(fila), getTextoISBN(fila));
+        if (!estaDisponible(fila)) {
+            libro.prestar();
+        }
+        return libro;
+    }
+
+    // Cuenta los libros disponibles con popcount sobre el bitset
+    size_t contarDisponibles() const {
+        size_t total = 0;
+        for (size_t w = 0; w < numPalabras(); w++) {
+            total += contarBits(disponibles[w].load(memory_order_relaxed));
+        }
+        return total;
+    }
+
+    size_t contarPrestados() const { return size() - contarDisponibles(); }
+
+    // Métodos para guardar y recuperar todas las columnas
+    void guardar(FILE* archivo) const {
+        textos.guardar(archivo);
+        escribirVector(archivo, titulos);
+        escribirVector(archivo, autores);
+        escribirVector(archivo, isbns);
+        escribirVector(archivo, textosISBN);
+        vector<uint64_t> palabras(numPalabras());
+        for (size_t w = 0; w < palabras.size(); w++) {
+            palabras[w] = disponibles[w].load();
+        }
+        escribirVector(archivo, palabras);
+    }
+
+    bool cargar(LectorBinario& lector) {
+        vector<uint64_t> palabras;
+        if (!textos.cargar(lector) || !lector.leerVector(titulos) ||
+            !lector.leerVector(autores) || !lector.leerVector(isbns) ||
+            !lector.leerVector(textosISBN) || !lector.leerVector(palabras) ||
+            titulos.size() != isbns.size() || autores.size() != isbns.size() ||
+            textosISBN.size() != isbns.size() || palabras.size() != numPalabras()) {
+            return false;
+        }
+        disponibles.reset();
+        capacidadPalabras = 0;
+        asegurarPalabras(palabras.size());
+        for (size_t w = 0; w < palabras.size(); w++) {
+            disponibles[w].store(palabras[w]);
+        }
+        return true;
+    }
+
+    // Llama a funcion(fila) para cada libro que cumple el filtro,
+    // recorriendo el bitset palabra a palabra
+    template <typename Funcion>
+    void recorrer(FiltroLibros filtro, Funcion funcion) const {
+        for (size_t w = 0; w < numPalabras(); w++) {
+            uint64_t palabra = ~0ULL;
+            if (filtro == DISPONIBLES) {
+                palabra = disponibles[w].load(memory_order_relaxed);
+            } else if (filtro == PRESTADOS) {
+                palabra = ~disponibles[w].load(memory_order_relaxed);
+            }
+            size_t restantes = size() - w * 64;
+            if (restantes < 64) {
+                palabra &= (1ULL << restantes) - 1; // Ignorar bits fuera del catálogo
+            }
+            while (palabra) {
+                funcion(w * 64 + primerBit(palabra));
+                palabra &= palabra - 1;
+            }
+        }
+    }
+};
+
+// ===== CLASE INDICETEXTO =====
+// Índice invertido de las palabras de títulos y autores. Cada palabra
+// (término) guarda la lista de filas que la contienen, y cada trigrama
+// guarda los términos que lo contienen para resolver búsquedas parciales
+class IndiceTexto {
+private:
+    unordered_map<string, uint32_t> idTerminos;
+    vector<string> terminos;
+    vector<vector<uint32_t>> filasPorTermino;             // Filas en orden ascendente
+    unordered_map<uint32_t, vector<uint32_t>> trigramas; // Trigrama -> ids de término
+    size_t totalDocumentos;
+
+    // Empaqueta tres caracteres consecutivos en un entero
+    static uint32_t trigrama(const string& texto, size_t i) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(texto[i])) << 16) |
+               (static_cast<uint32_t>(static_cast<unsigned char>(texto[i + 1])) << 8) |
+               static_cast<uint32_t>(static_cast<unsigned char>(texto[i + 2]));
+    }
+
+    uint32_t registrarTermino(const string& termino) {
+        auto it = idTerminos.find(termino);
+        if (it != idTerminos.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(terminos.size());
+        idTerminos.emplace(termino, id);
+        terminos.push_back(termino);
+        filasPorTermino.emplace_back();
+        for (size_t i = 0; i + 3 <= termino.size(); i++) {
+            auto& lista = trigramas[trigrama(termino, i)];
+            if (lista.empty() || lista.back() != id) {
+                lista.push_back(id);
+            }
+        }
+        return id;
+    }
+
+    // Peso de un término: los términos raros puntúan más (IDF)
+    double peso(uint32_t id) const {
+        return log(1.0 + static_cast<double>(totalDocumentos) / filasPorTermino[id].size());
+    }
+
+    // Puntos de un término para una palabra de la consulta: el doble si
+    // coincide entera
+    double puntuar(uint32_t id, const string& palabra) const {
+        return peso(id) * (terminos[id] == palabra ? 2.0 : 1.0);
+    }
+
+    // Términos que responden a una palabra de la consulta: con tres letras
+    // o más, los que la contienen; las más cortas solo coinciden enteras
+    vector<uint32_t> terminosDe(const string& palabra) const {
+        if (palabra.size() >= 3) {
+            return terminosQueContienen(palabra);
+        }
+        auto it = idTerminos.find(palabra);
+        return (it == idTerminos.end()) ? vector<uint32_t>() : vector<uint32_t>(1, it->second);
+    }
+
+    // Ids de los términos que contienen la palabra como subcadena
+    vector<uint32_t> terminosQueContienen(const string& palabra) const {
+        vector<uint32_t> candidatos;
+        for (size_t i = 0; i + 3 <= palabra.size(); i++) {
+            auto it = trigramas.find(trigrama(palabra, i));
+            if (it == trigramas.end()) {
+                return vector<uint32_t>();
+            }
+            if (i == 0) {
+                candidatos = it->second;
+            } else {
+                vector<uint32_t> comunes;
+                set_intersection(candidatos.begin(), candidatos.end(),
+                                 it->second.begin(), it->second.end(),
+                                 back_inserter(comunes));
+                candidatos.swap(comunes);
+            }
+            if (candidatos.empty()) {
+                break;
+            }
+        }
+        // Los trigramas solo filtran: se confirma la subcadena completa
+        vector<uint32_t> resultado;
+        for (uint32_t id : candidatos) {
+            if (terminos[id].find(palabra) != string::npos) {
+                resultado.push_back(id);
+            }
+        }
+        return resultado;
+    }
+
+public:
+    IndiceTexto() : totalDocumentos(0) {}
+
+    // Pasa a minúsculas y elimina las tildes (UTF-8) de un texto
+    static string plegar(const string& texto) {
+        string resultado;
+        resultado.reserve(texto.size());
+        for (size_t i = 0; i < texto.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(texto[i]);
+            if (c == 0xC3 && i + 1 < texto.size()) {
+                unsigned char s = static_cast<unsigned char>(texto[i + 1]) | 0x20; // Minúscula
+                char base = 0;
+                if (s >= 0xA0 && s <= 0xA5) base = 'a';
+                else if (s == 0xA7) base = 'c';
+                else if (s >= 0xA8 && s <= 0xAB) base = 'e';
+                else if (s >= 0xAC && s <= 0xAF) base = 'i';
+                else if (s == 0xB1) base = 'n';
+                else if (s >= 0xB2 && s <= 0xB6) base = 'o';
+                else if (s >= 0xB9 && s <= 0xBC) base = 'u';
+                if (base) {
+                    resultado += base;
+                    i++;
+                    continue;
+                }
+            }
+            resultado += static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+        }
+        return resultado;
+    }
+
+    // Divide un texto plegado en palabras (separadores: ASCII no alfanumérico)
+    static vector<string> tokenizar(const string& texto) {
+        vector<string> palabras;
+        string actual;
+        for (char c : plegar(texto)) {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (u >= 0x80 || (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z')) {
+                actual += c;
+            } else if (!actual.empty()) {
+                palabras.push_back(actual);
+                actual.clear();
+            }
+        }
+        if (!actual.empty()) {
+            palabras.push_back(actual);
+        }
+        return palabras;
+    }
+
+    // Indexa un libro; las filas deben añadirse en orden creciente
+    void agregar(uint32_t fila, const string& titulo, const string& autor) {
+        for (const string& texto : {titulo, autor}) {
+            for (const auto& palabra : tokenizar(texto)) {
+                auto& filas = filasPorTermino[registrarTermino(palabra)];
+                if (filas.empty() || filas.back() != fila) {
+                    filas.push_back(fila);
+                }
+            }
+        }
+        totalDocumentos++;
+    }
+
+    // Devuelve las filas que contienen todas las palabras de la consulta
+    // (completas o como parte de otra palabra), ordenadas por relevancia.
+    // Las listas de filas están ordenadas: se parte de la palabra más rara
+    // y cada palabra siguiente solo se busca (con búsqueda binaria) en las
+    // filas que siguen en carrera, así el coste depende sobre todo de la
+    // lista más corta y no del tamaño de las demás.
+    vector<uint32_t> buscar(const string& consulta, size_t maximo) const {
+        vector<string> palabras = tokenizar(consulta);
+        if (palabras.empty()) {
+            return vector<uint32_t>();
+        }
+
+        // Términos de cada palabra y cuántas filas suman sus listas
+        vector<vector<uint32_t>> idsPorPalabra(palabras.size());
+        vector<size_t> tamanos(palabras.size(), 0);
+        for (size_t p = 0; p < palabras.size(); p++) {
+            idsPorPalabra[p] = terminosDe(palabras[p]);
+            for (uint32_t id : idsPorPalabra[p]) {
+                tamanos[p] += filasPorTermino[id].size();
+            }
+            if (tamanos[p] == 0) {
+                return vector<uint32_t>();
+            }
+        }
+        vector<size_t> orden(palabras.size());
+        for (size_t p = 0; p < orden.size(); p++) {
+            orden[p] = p;
+        }
+        sort(orden.begin(), orden.end(), [&](size_t a, size_t b) {
+            return tamanos[a] < tamanos[b];
+        });
+
+        // Candidatos: las filas de la palabra más rara, en orden de fila,
+        // con su mejor puntuación (coincidencia completa vale el doble que
+        // una parcial)
+        size_t primera = orden[0];
+        vector<pair<uint32_t, double>> candidatos;
+        candidatos.reserve(tamanos[primera]);
+        for (uint32_t id : idsPorPalabra[primera]) {
+            double puntos = puntuar(id, palabras[primera]);
+            for (uint32_t fila : filasPorTermino[id]) {
+                candidatos.push_back(make_pair(fila, puntos));
+            }
+        }
+        if (idsPorPalabra[primera].size() > 1) {
+            sort(candidatos.begin(), candidatos.end());
+            size_t destino = 0;
+            for (size_t i = 0; i < candidatos.size(); i++) {
+                if (destino > 0 && candidatos[destino - 1].first == candidatos[i].first) {
+                    candidatos[destino - 1].second = candidatos[i].second; // La mayor va detrás
+                } else {
+                    candidatos[destino++] = candidatos[i];
+                }
+            }
+            candidatos.resize(destino);
+        }
+
+        // Resto de palabras, de la más rara a la más común
+        vector<double> mejor;
+        for (size_t k = 1; k < orden.size() && !candidatos.empty(); k++) {
+            size_t p = orden[k];
+            mejor.assign(candidatos.size(), 0.0);
+            for (uint32_t id : idsPorPalabra[p]) {
+                double puntos = puntuar(id, palabras[p]);
+                const vector<uint32_t>& filas = filasPorTermino[id];
+                auto desde = filas.begin();
+                for (size_t c = 0; c < candidatos.size() && desde != filas.end(); c++) {
+                    desde = lower_bound(desde, filas.end(), candidatos[c].first);
+                    if (desde != filas.end() && *desde == candidatos[c].first) {
+                        mejor[c] = max(mejor[c], puntos);
+                    }
+                }
+            }
+            // Solo siguen las filas que también tienen esta palabra (los
+            // pesos son siempre mayores que cero)
+            size_t destino = 0;
+            for (size_t c = 0; c < candidatos.size(); c++) {
+                if (mejor[c] > 0.0) {
+                    candidatos[destino] = candidatos[c];
+                    candidatos[destino++].second += mejor[c];
+                }
+            }
+            candidatos.resize(destino);
+        }
+
+        vector<pair<double, uint32_t>> ranking;
+        ranking.reserve(candidatos.size());
+        for (const auto& c : candidatos) {
+            ranking.push_back(make_pair(-c.second, c.first));
+        }
+        size_t n = min(maximo, ranking.size());
+        partial_sort(ranking.begin(), ranking.begin() + n, ranking.end());
+
+        vector<uint32_t> filas;
+        for (size_t i = 0; i < n; i++) {
+            filas.push_back(ranking[i].second);
+        }
+        return filas;
+    }
+};
+
+// ===== CLASE ARCHIVOMAPEADO =====
+// Proyecta un archivo completo en memoria (mmap) para leerlo sin copias.
+// En Windows se lee el archivo entero a memoria.
+class ArchivoMapeado {
+private:
+    const char* datos;
+    size_t longitud;
+    bool abierto;
+#if defined(_WIN32)
+    string contenido;
+#else
+    void* mapa;
+#endif
+
+    ArchivoMapeado(const ArchivoMapeado&);            // No copiable
+    ArchivoMapeado& operator=(const ArchivoMapeado&);
+
+public:
+    explicit ArchivoMapeado(const string& ruta) : datos(""), longitud(0), abierto(false) {
+#if defined(_WIN32)
+        ifstream archivo(ruta.c_str(), ios::binary);
+        if (archivo) {
+            contenido.assign(istreambuf_iterator<char>(archivo), istreambuf_iterator<char>());
+            datos = contenido.data();
+            longitud = contenido.size();
+            abierto = true;
+        }
+#else
+        mapa = nullptr;
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            abierto = true;
+            longitud = static_cast<size_t>(info.st_size);
+            if (longitud > 0) {
+                mapa = mmap(nullptr, longitud, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapa == MAP_FAILED) {
+                    mapa = nullptr;
+                    longitud = 0;
+                    abierto = false;
+                } else {
+                    madvise(mapa, longitud, MADV_SEQUENTIAL);
+                    datos = static_cast<const char*>(mapa);
+                }
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~ArchivoMapeado() {
+#if !defined(_WIN32)
+        if (mapa) {
+            munmap(mapa, longitud);
+        }
+#endif
+    }
+
+    bool estaAbierto() const { return abierto; }
+    const char* getDatos() const { return datos; }
+    size_t getLongitud() const { return longitud; }
+};
+
+// ===== CLASE LECTORCSV =====
+// Analiza en paralelo un CSV (título, autor, ISBN) ya cargado en memoria.
+// Cada hilo procesa un trozo del archivo cortado en un salto de línea y
+// genera registros que apuntan directamente al texto original. Un campo
+// entre comillas puede contener saltos de línea (Informe los escribe así):
+// solo separan registros los saltos que no están entre comillas, tanto al
+// cortar los trozos como dentro de cada uno. Las columnas que siguen a la
+// tercera (como el estado de una exportación) se ignoran.
+struct RegistroCSV {
+    const char* campos[3];
+    size_t longitudes[3];
+    bool escapado[3]; // El campo contiene comillas dobles escapadas ("")
+    uint64_t isbn;
+};
+
+class LectorCSV {
+private:
+    const char* datos;
+    size_t longitud;
+
+    // Lee un campo que empieza en p; deja p tras el campo
+    static bool leerCampo(const char*& p, const char* fin, const char*& campo,
+                          size_t& tamano, bool& escapado) {
+        escapado = false;
+        if (p < fin && *p == '"') {
+            campo = ++p;
+            while (p < fin) {
+                if (*p == '"') {
+                    if (p + 1 < fin && p[1] == '"') {
+                        escapado = true;
+                        p += 2;
+                        continue;
+                    }
+                    break;
+                }
+                p++;
+            }
+            if (p == fin) {
+                return false; // Comillas sin cerrar
+            }
+            tamano = static_cast<size_t>(p - campo);
+            p++;
+            return p == fin || *p == ',';
+        }
+        campo = p;
+        while (p < fin && *p != ',') {
+            p++;
+        }
+        tamano = static_cast<size_t>(p - campo);
+        return true;
+    }
+
+    // Primer salto de línea desde p que no está entre comillas (o fin);
+    // entreComillas indica si p ya está dentro de un campo entre comillas
+    static const char* finRegistro(const char* p, const char* fin, bool entreComillas = false) {
+        const char* salto = static_cast<const char*>(memchr(p, '\n', fin - p));
+        if (!salto) {
+            salto = fin;
+        }
+        if (!entreComillas && !memchr(p, '"', salto - p)) {
+            return salto; // Caso habitual: línea sin comillas
+        }
+        for (; p < fin; p++) {
+            if (*p == '"') {
+                entreComillas = !entreComillas; // "" cambia dos veces: sin efecto
+            } else if (*p == '\n' && !entreComillas) {
+                return p;
+            }
+        }
+        return fin;
+    }
+
+    // Analiza los registros de [inicio, fin); devuelve los rechazados
+    static size_t analizarTrozo(const char* inicio, const char* fin, bool primerTrozo,
+                                vector<RegistroCSV>& registros) {
+        size_t rechazados = 0;
+        bool primeraLinea = primerTrozo;
+        const char* p = inicio;
+        while (p < fin) {
+            const char* finLinea = finRegistro(p, fin);
+            const char* siguiente = (finLinea < fin) ? finLinea + 1 : fin;
+            if (finLinea > p && finLinea[-1] == '\r') {
+                finLinea--;
+            }
+            if (finLinea == p) { // Línea vacía
+                p = siguiente;
+                continue;
+            }
+
+            RegistroCSV r;
+            bool valido = true;
+            for (int c = 0; c < 3 && valido; c++) {
+                valido = leerCampo(p, finLinea, r.campos[c], r.longitudes[c], r.escapado[c]);
+                if (valido && c < 2) {
+                    valido = (p < finLinea);
+                    p++; // Saltar la coma
+                }
+            }
+            valido = valido && (p == finLinea || *p == ',');
+            r.isbn = valido ? normalizarISBN(r.campos[2], r.longitudes[2], true) : 0;
+
+            if (r.isbn != 0) {
+                registros.push_back(r);
+            } else if (!(primeraLinea && valido && !tieneDigitos(r.campos[2], r.longitudes[2]))) {
+                rechazados++; // La cabecera (sin dígitos en el ISBN) no cuenta como error
+            }
+            primeraLinea = false;
+            p = siguiente;
+        }
+        return rechazados;
+    }
+
+    static bool tieneDigitos(const char* texto, size_t tamano) {
+        for (size_t i = 0; i < tamano; i++) {
+            if (texto[i] >= '0' && texto[i] <= '9') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    LectorCSV(const char* d, size_t l) : datos(d), longitud(l) {}
+
+    // Devuelve los registros válidos en el orden del archivo; con hilos = 0
+    // se usa un hilo por núcleo
+    vector<RegistroCSV> analizar(size_t& rechazados, size_t hilos = 0) const {
+        const size_t minimoPorHilo = 1 << 20; // No merece la pena trocear menos de 1 MiB
+        if (hilos == 0) {
+            hilos = max(1u, thread::hardware_concurrency());
+        }
+        hilos = min(hilos, longitud / minimoPorHilo + 1);
+        const char* finDatos = datos + longitud;
+
+        // Comillas de cada trozo, contadas en paralelo: su paridad dice si
+        // el principio del trozo siguiente cae dentro de un campo
+        vector<size_t> comillas(hilos, 0);
+        vector<thread> trabajadores;
+        for (size_t h = 0; h + 1 < hilos; h++) {
+            trabajadores.emplace_back([&, h]() {
+                comillas[h] = static_cast<size_t>(count(datos + longitud * h / hilos,
+                                                        datos + longitud * (h + 1) / hilos, '"'));
+            });
+        }
+        for (auto& t : trabajadores) {
+            t.join();
+        }
+        trabajadores.clear();
+
+        // Cortes en saltos de línea fuera de comillas para no partir registros
+        vector<const char*> cortes(1, datos);
+        size_t comillasAntes = 0;
+        for (size_t h = 1; h < hilos; h++) {
+            comillasAntes += comillas[h - 1];
+            const char* corte = datos + longitud * h / hilos;
+            bool entreComillas = comillasAntes % 2 != 0;
+            if (corte < cortes.back()) { // El corte anterior ya pasó de aquí
+                corte = cortes.back();
+                entreComillas = false;
+            }
+            const char* salto = finRegistro(corte, finDatos, entreComillas);
+            cortes.push_back(salto < finDatos ? salto + 1 : finDatos);
+        }
+        cortes.push_back(finDatos);
+
+        vector<vector<RegistroCSV>> partes(hilos);
+        vector<size_t> rechazosPorParte(hilos, 0);
+        for (size_t h = 0; h < hilos; h++) {
+            trabajadores.emplace_back([&, h]() {
+                partes[h].reserve(static_cast<size_t>(cortes[h + 1] - cortes[h]) / 48);
+                rechazosPorParte[h] = analizarTrozo(cortes[h], cortes[h + 1], h == 0, partes[h]);
+            });
+        }
+        for (auto& t : trabajadores) {
+            t.join();
+        }
+
+        size_t total = 0;
+        rechazados = 0;
+        for (size_t h = 0; h < hilos; h++) {
+            total += partes[h].size();
+            rechazados += rechazosPorParte[h];
+        }
+        vector<RegistroCSV> registros;
+        registros.reserve(total);
+        for (auto& parte : partes) {
+            registros.insert(registros.end(), parte.begin(), parte.end());
+        }
+        return registros;
+    }
+
+    // Texto de un campo, deshaciendo las comillas escapadas
+    static string texto(const RegistroCSV& r, int campo) {
+        string resultado(r.campos[campo], r.longitudes[campo]);
+        if (r.escapado[campo]) {
+            size_t destino = 0;
+            for (size_t i = 0; i < resultado.size(); i++, destino++) {
+                resultado[destino] = resultado[i];
+                if (resultado[i] == '"') {
+                    i++; // Saltar la segunda comilla
+                }
+            }
+            resultado.resize(destino);
+        }
+        return resultado;
+    }
+};
+
+// Préstamo que ha superado su fecha de devolución
+struct PrestamoVencido {
+    string isbn;
+    string titulo;
+    int usuarioId;
+    uint32_t dia; // Día en que venció
+};
+
+// Resumen de una carga masiva del catálogo
+struct ResultadoCarga {
+    bool archivoAbierto;
+    size_t cargados;
+    size_t rechazados; // Líneas mal formadas o con ISBN inválido
+    size_t duplicados;
+};
+
+// ===== FUNCIONES AUXILIARES DE FECHAS =====
+// Los días se cuentan desde el 1970-01-01 (UTC)
+
+inline uint32_t diaDeHoy() {
+    return static_cast<uint32_t>(time(nullptr) / 86400);
+}
+
+inline string formatearDia(uint32_t dia) {
+    time_t instante = static_cast<time_t>(dia) * 86400;
+    char texto[16];
+    strftime(texto, sizeof(texto), "%Y-%m-%d", gmtime(&instante));
+    return texto;
+}
+
+// ===== CLASE RUEDATEMPORAL =====
+// Rueda de tiempos jerárquica para vencimientos. Cada nivel tiene 64
+// ranuras: el nivel 0 cuenta ticks, el 1 grupos de 64 ticks, etc. Un
+// elemento se coloca en el nivel que corresponde a lo lejos que vence y
+// baja de nivel (cascada) a medida que se acerca su tick. Los elementos
+// son los manejadores de libro, enlazados en listas dobles dentro de un
+// vector, así que programar y cancelar son O(1) y avanzar un tick solo
+// cuesta lo que venza en él (más las cascadas, amortizadas).
+class RuedaTemporal {
+private:
+    static const int BITS = 6;
+    static const uint32_t RANURAS = 1u << BITS;
+    static const int NIVELES = 4;
+    static const uint32_t HORIZONTE = 1u << (BITS * NIVELES); // Ticks máximos hacia delante
+    static const uint32_t NINGUNO = 0xFFFFFFFFu;
+
+    struct Nodo {
+        uint32_t siguiente;
+        uint32_t anterior;
+        uint32_t vence;
+        uint32_t lista;    // Ranura en la que está o NINGUNO si no está programado
+        int32_t etiqueta;  // Dato asociado (el usuario que tiene el libro)
+    };
+
+    vector<Nodo> nodos;
+    uint32_t cabezas[NIVELES * RANURAS];
+    uint32_t ahora; // Último tick procesado
+    size_t programados;
+
+    // Ranura que corresponde a un vencimiento según la distancia a ahora
+    uint32_t listaPara(uint32_t vence) const {
+        uint32_t distancia = vence - ahora;
+        int nivel = 0;
+        while (nivel < NIVELES - 1 && distancia >= (1u << (BITS * (nivel + 1)))) {
+            nivel++;
+        }
+        return nivel * RANURAS + ((vence >> (BITS * nivel)) & (RANURAS - 1));
+    }
+
+    void enlazar(uint32_t id, uint32_t lista) {
+        Nodo& n = nodos[id];
+        n.lista = lista;
+        n.anterior = NINGUNO;
+        n.siguiente = cabezas[lista];
+        if (n.siguiente != NINGUNO) {
+            nodos[n.siguiente].anterior = id;
+        }
+        cabezas[lista] = id;
+    }
+
+    void desenlazar(uint32_t id) {
+        Nodo& n = nodos[id];
+        if (n.anterior != NINGUNO) {
+            nodos[n.anterior].siguiente = n.siguiente;
+        } else {
+            cabezas[n.lista] = n.siguiente;
+        }
+        if (n.siguiente != NINGUNO) {
+            nodos[n.siguiente].anterior = n.anterior;
+        }
+        n.lista = NINGUNO;
+    }
+
+    // Reparte en niveles inferiores los elementos de una ranura
+    void cascada(int nivel) {
+        uint32_t lista = nivel * RANURAS + ((ahora >> (BITS * nivel)) & (RANURAS - 1));
+        uint32_t id = cabezas[lista];
+        cabezas[lista] = NINGUNO;
+        while (id != NINGUNO) {
+            uint32_t siguiente = nodos[id].siguiente;
+            enlazar(id, listaPara(nodos[id].vence));
+            id = siguiente;
+        }
+    }
+
+public:
+    explicit RuedaTemporal(uint32_t inicio = 0) : ahora(inicio), programados(0) {
+        fill(cabezas, cabezas + NIVELES * RANURAS, NINGUNO);
+    }
+
+    uint32_t getAhora() const { return ahora; }
+    size_t size() const { return programados; }
+
+    // Prepara nodos para los manejadores [0, n)
+    void asegurarCapacidad(size_t n) {
+        if (n > nodos.size()) {
+            nodos.resize(n, Nodo{NINGUNO, NINGUNO, 0, NINGUNO, 0});
+        }
+    }
+
+    // Reinicia la rueda vacía en el tick indicado
+    void reiniciar(uint32_t inicio) {
+        for (auto& n : nodos) {
+            n.lista = NINGUNO;
+        }
+        fill(cabezas, cabezas + NIVELES * RANURAS, NINGUNO);
+        ahora = inicio;
+        programados = 0;
+    }
+
+    bool estaProgramado(uint32_t id) const { return nodos[id].lista != NINGUNO; }
+    uint32_t getVence(uint32_t id) const { return nodos[id].vence; }
+    int32_t getEtiqueta(uint32_t id) const { return nodos[id].etiqueta; }
+
+    // Programa (o reprograma) un vencimiento; como pronto vence en el tick siguiente
+    void programar(uint32_t id, uint32_t vence, int32_t etiqueta) {
+        cancelar(id);
+        if (vence <= ahora) {
+            vence = ahora + 1;
+        } else if (vence - ahora >= HORIZONTE) {
+            vence = ahora + HORIZONTE - 1;
+        }
+        nodos[id].vence = vence;
+        nodos[id].etiqueta = etiqueta;
+        enlazar(id, listaPara(vence));
+        programados++;
+    }
+
+    bool cancelar(uint32_t id) {
+        if (nodos[id].lista == NINGUNO) {
+            return false;
+        }
+        desenlazar(id);
+        programados--;
+        return true;
+    }
+
+    // Avanza hasta el tick indicado y añade a vencidos los elementos que
+    // vencen por el camino (dejan de estar programados)
+    void avanzar(uint32_t hasta, vector<uint32_t>& vencidos) {
+        while (ahora < hasta) {
+            ahora++;
+            for (int nivel = 1; nivel < NIVELES; nivel++) {
+                if ((ahora & ((1u << (BITS * nivel)) - 1)) != 0) {
+                    break;
+                }
+                cascada(nivel);
+            }
+            uint32_t lista = ahora & (RANURAS - 1);
+            uint32_t id = cabezas[lista];
+            cabezas[lista] = NINGUNO;
+            while (id != NINGUNO) {
+                uint32_t siguiente = nodos[id].siguiente;
+                nodos[id].lista = NINGUNO;
+                vencidos.push_back(id);
+                programados--;
+                id = siguiente;
+            }
+        }
+    }
+};
+
+// Definir constantes estáticas
+const int RuedaTemporal::BITS;
+const uint32_t RuedaTemporal::RANURAS;
+const int RuedaTemporal::NIVELES;
+const uint32_t RuedaTemporal::HORIZONTE;
+const uint32_t RuedaTemporal::NINGUNO;
+
+// ===== CLASE DIARIOEVENTOS =====
+// Registro de escritura anticipada (WAL): cada cambio de la biblioteca se
+// añade al final del archivo para poder repetirlo tras un reinicio
+enum TipoEvento {
+    EVENTO_ALTA_LIBRO = 1,
+    EVENTO_ALTA_USUARIO,
+    EVENTO_PRESTAMO,
+    EVENTO_DEVOLUCION,
+    EVENTO_AVANCE_RELOJ
+};
+
+struct Evento {
+    TipoEvento tipo;
+    int usuarioId;  // Alta de usuario, préstamo y devolución
+    uint64_t isbn;  // Alta de libro, préstamo y devolución
+    uint32_t dia;   // Vencimiento del préstamo o nuevo día del reloj
+    string texto;   // Título o nombre del usuario
+    string autor;   // Solo en el alta de libro
+    string textoISBN; // Solo en el alta de libro: el ISBN tal como se dio
+};
+
+class DiarioEventos {
+private:
+    // Parte fija de cada registro: usuario, ISBN, día y longitudes de los textos
+    static const size_t TAMANO_FIJO = sizeof(int) + sizeof(uint64_t) + sizeof(uint32_t) +
+                                      3 * sizeof(uint32_t);
+
+    FILE* archivo;
+    size_t eventos; // Eventos escritos desde la última compactación
+
+    DiarioEventos(const DiarioEventos&);            // No copiable
+    DiarioEventos& operator=(const DiarioEventos&);
+
+public:
+    DiarioEventos() : archivo(nullptr), eventos(0) {}
+    ~DiarioEventos() { cerrar(); }
+
+    bool estaAbierto() const { return archivo != nullptr; }
+    size_t getEventos() const { return eventos; }
+
+    // Abre el archivo para añadir; con vaciar se descarta su contenido
+    bool abrir(const string& ruta, bool vaciar) {
+        cerrar();
+        archivo = fopen(ruta.c_str(), vaciar ? "wb" : "ab");
+        eventos = 0;
+        return archivo != nullptr;
+    }
+
+    void cerrar() {
+        if (archivo) {
+            fclose(archivo);
+            archivo = nullptr;
+        }
+    }
+
+    // Escribe un evento: tipo, longitud del resto, parte fija y textos.
+    // Todo pasa por el búfer del archivo y sale con un único fflush;
+    // con vaciar = false el evento espera al siguiente vaciado (lotes).
+    void registrar(const Evento& e, bool vaciar = true) {
+        uint32_t longitudes[3] = {static_cast<uint32_t>(e.texto.size()),
+                                  static_cast<uint32_t>(e.autor.size()),
+                                  static_cast<uint32_t>(e.textoISBN.size())};
+        uint8_t tipo = static_cast<uint8_t>(e.tipo);
+        uint32_t longitud = static_cast<uint32_t>(TAMANO_FIJO) + longitudes[0] + longitudes[1] +
+                            longitudes[2];
+
+        char cabecera[1 + sizeof(longitud) + TAMANO_FIJO];
+        char* p = cabecera;
+        memcpy(p, &tipo, 1);                             p += 1;
+        memcpy(p, &longitud, sizeof(longitud));          p += sizeof(longitud);
+        memcpy(p, &e.usuarioId, sizeof(e.usuarioId));    p += sizeof(e.usuarioId);
+        memcpy(p, &e.isbn, sizeof(e.isbn));              p += sizeof(e.isbn);
+        memcpy(p, &e.dia, sizeof(e.dia));                p += sizeof(e.dia);
+        memcpy(p, longitudes, sizeof(longitudes));
+
+        fwrite(cabecera, 1, sizeof(cabecera), archivo);
+        fwrite(e.texto.data(), 1, e.texto.size(), archivo);
+        fwrite(e.autor.data(), 1, e.autor.size(), archivo);
+        fwrite(e.textoISBN.data(), 1, e.textoISBN.size(), archivo);
+        if (vaciar) {
+            fflush(archivo);
+        }
+        eventos++;
+    }
+
+    // Envía al sistema lo que quede en el búfer
+    void vaciar() {
+        fflush(archivo);
+    }
+
+    // Lee todos los eventos completos; un último registro cortado
+    // (por una caída a mitad de escritura) se ignora
+    static vector<Evento> leer(const string& ruta) {
+        vector<Evento> resultado;
+        ArchivoMapeado mapa(ruta);
+        LectorBinario lector(mapa.getDatos(), mapa.getLongitud());
+        uint8_t tipo;
+        uint32_t longitud;
+        while (lector.leer(tipo) && lector.leer(longitud) && lector.restantes() >= longitud) {
+            Evento e;
+            uint32_t longitudes[3];
+            if (tipo < EVENTO_ALTA_LIBRO || tipo > EVENTO_AVANCE_RELOJ ||
+                !lector.leer(e.usuarioId) || !lector.leer(e.isbn) || !lector.leer(e.dia) ||
+                !lector.leer(longitudes) ||
+                longitud != TAMANO_FIJO + longitudes[0] + longitudes[1] + longitudes[2] ||
+                !lector.leerBytes(e.texto, longitudes[0]) ||
+                !lector.leerBytes(e.autor, longitudes[1]) ||
+                !lector.leerBytes(e.textoISBN, longitudes[2])) {
+                break;
+            }
+            e.tipo = static_cast<TipoEvento>(tipo);
+            resultado.push_back(e);
+        }
+        return resultado;
+    }
+};
+
+// ===== CLASE BIBLIOTECA =====
+// Resultado de una operación de préstamo o devolución
+enum ResultadoPrestamo {
+    OPERACION_OK,
+    LIBRO_NO_ENCONTRADO,
+    USUARIO_NO_ENCONTRADO,
+    LIBRO_NO_DISPONIBLE,
+    LIBRO_NO_PRESTADO
+};
+
+// Texto breve de cada resultado, para informes
+const char* nombreResultado(ResultadoPrestamo r) {
+    switch (r) {
+        case OPERACION_OK:          return "OK";
+        case LIBRO_NO_ENCONTRADO:   return "libro no encontrado";
+        case USUARIO_NO_ENCONTRADO: return "usuario no encontrado";
+        case LIBRO_NO_DISPONIBLE:   return "libro no disponible";
+        case LIBRO_NO_PRESTADO:     return "libro no prestado a ese usuario";
+    }
+    return "desconocido";
+}
+
+// Operación de un lote de préstamos y devoluciones
+enum TipoOperacion {
+    OP_PRESTAMO,
+    OP_DEVOLUCION
+};
+
+struct OperacionPrestamo {
+    TipoOperacion tipo;
+    string isbn;
+    int usuarioId;
+    int dias;  // Plazo del préstamo; se ignora en las devoluciones
+};
+
+// Préstamos y devoluciones pueden hacerse desde varios hilos a la vez
+// (por ejemplo, un hilo por puesto de autopréstamo); las altas de libros
+// y usuarios deben terminar antes de empezar a prestar.
+class Biblioteca {
+private:
+    CatalogoColumnar catalogo;
+    vector<shared_ptr<Usuario>> usuarios;
+    TablaHash indiceLibros;   // ISBN normalizado -> fila del catálogo
+    mutable IndiceTexto indiceTexto;      // Palabras de títulos y autores -> filas
+    mutable atomic<bool> textoPendiente;  // Índice por reconstruir tras un snapshot
+    mutable mutex cerrojoTexto;
+    TablaHash indiceUsuarios; // ID de usuario -> posición en usuarios
+
+    // Vencimientos de los préstamos (tick = un día), repartidos en una
+    // rueda por cada cerrojo de libros: el libro f es el nodo
+    // f / CERROJOS_LIBROS de la rueda f % CERROJOS_LIBROS, y esa rueda solo
+    // se toca con el cerrojo de su libro. diaActual es el día al que han
+    // llegado todas; cerrojoReloj hace que solo un hilo las avance a la vez.
+    static const size_t CERROJOS_LIBROS = 64;
+    RuedaTemporal vencimientos[CERROJOS_LIBROS];
+    atomic<uint32_t> diaActual;
+    mutex cerrojoReloj;
+
+    RuedaTemporal& ruedaDe(int libro) {
+        return vencimientos[static_cast<size_t>(libro) % CERROJOS_LIBROS];
+    }
+
+    static uint32_t nodoDe(int libro) {
+        return static_cast<uint32_t>(static_cast<size_t>(libro) / CERROJOS_LIBROS);
+    }
+
+    // Persistencia: snapshot binario + WAL de los cambios posteriores
+    DiarioEventos diario;
+    string rutaSnapshot;
+    string rutaDiario;
+    size_t umbralCompactacion;
+    mutex cerrojoDiario;
+    // Se pone a true al abrir el WAL; sin persistencia, los préstamos no
+    // llegan a tomar cerrojoDiario
+    atomic<bool> persistente;
+
+    // Un préstamo o una devolución se aplica y se anota en el diario con el
+    // cerrojo de su libro tomado, así el diario tiene las operaciones de
+    // cada libro en el mismo orden en que cambiaron su estado. Los libros
+    // se reparten entre unos pocos cerrojos por su fila. Los cerrojos se
+    // toman siempre en el orden cerrojoReloj, cerrojos de libros,
+    // cerrojoDiario.
+    mutex cerrojosLibros[CERROJOS_LIBROS];
 
-    // Métodos para cambiar estado
-    void prestar() { disponible = false; }
-    void devolver() { disponible = true; }
+    mutex& cerrojoLibro(int libro) {
+        return cerrojosLibros[static_cast<size_t>(libro) % CERROJOS_LIBROS];
+    }
 
-    // Método para mostrar información
-    void mostrarInfo() const {
-        cout << "Título: " << titulo << endl;
-        cout << "Autor: " << autor << endl;
-        cout << "ISBN: " << isbn << endl;
-        cout << "Estado: " << (disponible ? "Disponible" : "Prestado") << endl;
+    // Toma el reloj y los cerrojos de todos los libros, siempre en el mismo
+    // orden; mientras se tienen no hay ningún préstamo ni devolución a
+    // medias y todas las ruedas están en el mismo día
+    void bloquearLibros() {
+        cerrojoReloj.lock();
+        for (size_t i = 0; i < CERROJOS_LIBROS; i++) {
+            cerrojosLibros[i].lock();
+        }
     }
-};
 
-// ===== CLASE USUARIO =====
-class Usuario {
-private:
-    string nombre;
-    int id;
-    vector<string> librosPrestados; // Guardamos ISBNs de los libros
+    void desbloquearLibros() {
+        for (size_t i = CERROJOS_LIBROS; i-- > 0; ) {
+            cerrojosLibros[i].unlock();
+        }
+        cerrojoReloj.unlock();
+    }
 
-public:
-    // Constructor
-    Usuario(string n, int i) : nombre(n), id(i) {}
+    // Clave del índice de usuarios a partir de su ID
+    static uint64_t claveUsuario(int id) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(id));
+    }
 
-    // Getters
-    string getNombre() const { return nombre; }
-    int getId() const { return id; }
-    vector<string> getLibrosPrestados() const { return librosPrestados; }
+    // Método auxiliar para buscar libro por ISBN (devuelve su fila o -1)
+    int buscarLibro(const string& isbn) const {
+        return indiceLibros.buscar(normalizarISBN(isbn));
+    }
 
-    // Métodos para gestionar préstamos
-    void agregarLibro(string isbn) {
-        librosPrestados.push_back(isbn);
+    // Método auxiliar para buscar usuario por ID
+    Usuario* buscarUsuario(int id) const {
+        int pos = indiceUsuarios.buscar(claveUsuario(id));
+        return (pos < 0) ? nullptr : usuarios[pos].get();
     }
 
-    void devolverLibro(string isbn) {
-        for (auto it = librosPrestados.begin(); it != librosPrestados.end(); ++it) {
-            if (*it == isbn) {
-                librosPrestados.erase(it);
-                break;
+    // El índice de texto no se guarda en el snapshot: se reconstruye desde
+    // el catálogo la primera vez que hace falta, no al arrancar
+    void asegurarIndiceTexto() const {
+        if (!textoPendiente.load()) {
+            return;
+        }
+        lock_guard<mutex> guarda(cerrojoTexto);
+        if (textoPendiente.load()) {
+            for (size_t fila = 0; fila < catalogo.size(); fila++) {
+                indiceTexto.agregar(static_cast<uint32_t>(fila), catalogo.getTitulo(fila),
+                                    catalogo.getAutor(fila));
             }
+            textoPendiente.store(false);
         }
     }
 
-    // Método para mostrar información
-    void mostrarInfo() const {
-        cout << "Usuario: " << nombre << " (ID: " << id << ")" << endl;
-        cout << "Libros prestados: " << librosPrestados.size() << endl;
-        if (!librosPrestados.empty()) {
-            cout << "ISBNs: ";
-            for (const auto& isbn : librosPrestados) {
-                cout << isbn << " ";
+    // Altas sin mensajes; devuelven false si ya existía
+    bool altaLibro(const string& titulo, const string& autor, uint64_t clave,
+                   const string& textoISBN) {
+        if (!indiceLibros.insertar(clave, static_cast<int>(catalogo.size()))) {
+            return false;
+        }
+        asegurarIndiceTexto();
+        size_t fila = catalogo.agregar(titulo, autor, clave, textoISBN);
+        indiceTexto.agregar(static_cast<uint32_t>(fila), titulo, autor);
+        int libro = static_cast<int>(fila);
+        lock_guard<mutex> guarda(cerrojoLibro(libro));
+        ruedaDe(libro).asegurarCapacidad(nodoDe(libro) + 1);
+        return true;
+    }
+
+    bool altaUsuario(const string& nombre, int id) {
+        if (!indiceUsuarios.insertar(claveUsuario(id), static_cast<int>(usuarios.size()))) {
+            return false;
+        }
+        usuarios.push_back(make_shared<Usuario>(nombre, id));
+        return true;
+    }
+
+    // Anota un evento en el WAL (si la persistencia está activa); con
+    // vaciar = false espera al siguiente vaciado (lotes). Devuelve true si
+    // el WAL ha llegado al umbral: quien llama debe llamar a
+    // compactarSiLleno() cuando ya no tenga el cerrojo de su libro.
+    bool registrarEvento(const Evento& e, bool vaciar = true) {
+        if (!persistente.load(memory_order_acquire)) {
+            return false;
+        }
+        lock_guard<mutex> guarda(cerrojoDiario);
+        if (!diario.estaAbierto()) {
+            return false;
+        }
+        diario.registrar(e, vaciar);
+        return diario.getEventos() >= umbralCompactacion;
+    }
+
+    // Vacía el diario una sola vez al terminar un lote; como registrarEvento
+    bool vaciarDiario() {
+        if (!persistente.load(memory_order_acquire)) {
+            return false;
+        }
+        lock_guard<mutex> guarda(cerrojoDiario);
+        if (!diario.estaAbierto()) {
+            return false;
+        }
+        diario.vaciar();
+        return diario.getEventos() >= umbralCompactacion;
+    }
+
+    // Compacta si el WAL sigue por encima del umbral (otro hilo puede
+    // haberlo hecho ya). Espera a que terminen los préstamos en curso, así
+    // el snapshot nunca ve un libro marcado como prestado que aún no está
+    // en la lista de su usuario. No debe tenerse ningún cerrojo de libro.
+    void compactarSiLleno() {
+        bloquearLibros();
+        {
+            lock_guard<mutex> guarda(cerrojoDiario);
+            if (diario.estaAbierto() && diario.getEventos() >= umbralCompactacion) {
+                compactarSinBloqueo();
             }
-            cout << endl;
         }
+        desbloquearLibros();
     }
-};
 
-// ===== CLASE BIBLIOTECA =====
-class Biblioteca {
-private:
-    vector<shared_ptr<Libro>> libros;
-    vector<shared_ptr<Usuario>> usuarios;
+    // Núcleo del préstamo con libro y usuario ya resueltos; deja en evento
+    // lo que hay que anotar en el diario
+    ResultadoPrestamo aplicarPrestamo(int libro, Usuario* usuario, int usuarioId,
+                                      int dias, Evento& evento) {
+        if (!catalogo.prestar(libro)) {
+            return LIBRO_NO_DISPONIBLE;
+        }
+        usuario->agregarLibro(static_cast<ManejadorLibro>(libro));
+        // El día de la propia rueda: si avanzarDias aún no ha llegado a
+        // ella, el préstamo es anterior al avance
+        RuedaTemporal& rueda = ruedaDe(libro);
+        uint32_t vence = rueda.getAhora() + static_cast<uint32_t>(max(dias, 1));
+        rueda.programar(nodoDe(libro), vence, usuarioId);
+        evento = Evento{EVENTO_PRESTAMO, usuarioId, catalogo.getISBN(libro), vence, "", "", ""};
+        return OPERACION_OK;
+    }
+
+    // Núcleo de la devolución con libro y usuario ya resueltos
+    ResultadoPrestamo aplicarDevolucion(int libro, Usuario* usuario, int usuarioId,
+                                        Evento& evento) {
+        if (!usuario->devolverLibro(static_cast<ManejadorLibro>(libro))) {
+            return LIBRO_NO_PRESTADO;
+        }
+        ruedaDe(libro).cancelar(nodoDe(libro));
+        catalogo.devolver(libro);
+        evento = Evento{EVENTO_DEVOLUCION, usuarioId, catalogo.getISBN(libro), 0, "", "", ""};
+        return OPERACION_OK;
+    }
 
-    // Método auxiliar para buscar libro por ISBN
-    shared_ptr<Libro> buscarLibro(string isbn) {
-        for (auto& libro : libros) {
-            if (libro->getISBN() == isbn) {
-                return libro;
+    // Repetición de eventos al recuperar. Un préstamo de un libro que ya
+    // está prestado se descarta, y una devolución solo se aplica si el
+    // usuario tiene el libro; así, repetir eventos que el snapshot ya
+    // reflejaba no cambia nada.
+    void repetirEvento(const Evento& e) {
+        int libro = indiceLibros.buscar(e.isbn);
+        Usuario* usuario = buscarUsuario(e.usuarioId);
+        switch (e.tipo) {
+        case EVENTO_ALTA_LIBRO:
+            altaLibro(e.texto, e.autor, e.isbn, e.textoISBN);
+            break;
+        case EVENTO_ALTA_USUARIO:
+            altaUsuario(e.texto, e.usuarioId);
+            break;
+        case EVENTO_PRESTAMO:
+            if (libro >= 0 && usuario && catalogo.prestar(libro)) {
+                usuario->agregarLibro(libro);
+                ruedaDe(libro).programar(nodoDe(libro), e.dia, e.usuarioId);
+            }
+            break;
+        case EVENTO_DEVOLUCION:
+            if (libro >= 0 && usuario && usuario->devolverLibro(libro)) {
+                catalogo.devolver(libro);
+                ruedaDe(libro).cancelar(nodoDe(libro));
+            }
+            break;
+        case EVENTO_AVANCE_RELOJ: {
+            vector<uint32_t> vencidos;
+            for (auto& rueda : vencimientos) {
+                rueda.avanzar(e.dia, vencidos);
             }
+            diaActual.store(max(diaActual.load(), e.dia));
+            break;
+        }
         }
-        return nullptr;
     }
 
-    // Método auxiliar para buscar usuario por ID
-    shared_ptr<Usuario> buscarUsuario(int id) {
-        for (auto& usuario : usuarios) {
-            if (usuario->getId() == id) {
-                return usuario;
+    // Escribe el snapshot en un archivo temporal y lo renombra al terminar,
+    // así una caída durante la escritura conserva el snapshot anterior.
+    // Requiere lo mismo que compactarSinBloqueo.
+    bool escribirSnapshot(const string& ruta) const {
+        string temporal = ruta + ".tmp";
+        FILE* archivo = fopen(temporal.c_str(), "wb");
+        if (!archivo) {
+            return false;
+        }
+        fwrite("BIBSNAP3", 1, 8, archivo);
+        escribirValor<uint32_t>(archivo, diaActual.load());
+        catalogo.guardar(archivo);
+        indiceLibros.guardar(archivo);
+        escribirValor<uint64_t>(archivo, usuarios.size());
+        for (const auto& usuario : usuarios) {
+            escribirValor<int32_t>(archivo, usuario->getId());
+            escribirTexto(archivo, usuario->getNombre());
+            vector<uint64_t> prestados;
+            vector<uint32_t> fechas; // Vencimiento de cada préstamo
+            for (ManejadorLibro libro : usuario->copiarLibrosPrestados()) {
+                prestados.push_back(catalogo.getISBN(libro));
+                fechas.push_back(vencimientos[libro % CERROJOS_LIBROS].getVence(nodoDe(libro)));
+            }
+            escribirVector(archivo, prestados);
+            escribirVector(archivo, fechas);
+        }
+        bool correcto = sincronizarArchivo(archivo);
+        correcto = (fclose(archivo) == 0) && correcto;
+        return correcto && rename(temporal.c_str(), ruta.c_str()) == 0;
+    }
+
+    // Carga un snapshot proyectado en memoria: las columnas se copian en
+    // bloque y las tablas hash no se reconstruyen
+    bool cargarSnapshot(const string& ruta) {
+        ArchivoMapeado archivo(ruta);
+        LectorBinario lector(archivo.getDatos(), archivo.getLongitud());
+        char firma[8];
+        uint32_t dia;
+        if (!lector.leer(firma) || memcmp(firma, "BIBSNAP3", 8) != 0 || !lector.leer(dia) ||
+            !catalogo.cargar(lector) || !indiceLibros.cargar(lector)) {
+            return false;
+        }
+        for (auto& rueda : vencimientos) {
+            rueda.asegurarCapacidad((catalogo.size() + CERROJOS_LIBROS - 1) / CERROJOS_LIBROS);
+            rueda.reiniciar(dia);
+        }
+        diaActual.store(dia);
+        uint64_t numUsuarios;
+        if (!lector.leer(numUsuarios)) {
+            return false;
+        }
+        for (uint64_t u = 0; u < numUsuarios; u++) {
+            int32_t id;
+            string nombre;
+            vector<uint64_t> prestados;
+            vector<uint32_t> fechas;
+            if (!lector.leer(id) || !lector.leerTexto(nombre) || !lector.leerVector(prestados) ||
+                !lector.leerVector(fechas) || fechas.size() != prestados.size()) {
+                return false;
             }
+            altaUsuario(nombre, id);
+            for (size_t i = 0; i < prestados.size(); i++) {
+                int libro = indiceLibros.buscar(prestados[i]);
+                if (libro < 0) {
+                    return false;
+                }
+                usuarios.back()->agregarLibro(static_cast<ManejadorLibro>(libro));
+                if (fechas[i] > dia) { // Los ya vencidos se notificaron antes del snapshot
+                    ruedaDe(libro).programar(nodoDe(libro), fechas[i], id);
+                }
+            }
+        }
+        textoPendiente.store(catalogo.size() > 0);
+        return true;
+    }
+
+    // Guarda el estado completo y vacía el WAL. Requiere cerrojoDiario y
+    // bloquearLibros() (o que nadie más use la biblioteca)
+    bool compactarSinBloqueo() {
+        if (!escribirSnapshot(rutaSnapshot)) {
+            return false;
         }
-        return nullptr;
+        return diario.abrir(rutaDiario, true);
     }
 
 public:
-    // Métodos para gestionar libros
+    // Plazo de préstamo por defecto, en días
+    static const int PLAZO_PRESTAMO = 14;
+
+    Biblioteca()
+        : textoPendiente(false), diaActual(diaDeHoy()), umbralCompactacion(0),
+          persistente(false) {
+        for (auto& rueda : vencimientos) {
+            rueda.reiniciar(diaActual.load());
+        }
+    }
+
+    // Métodos para gestionar libros. El ISBN debe ser un ISBN-10 o ISBN-13
+    // (con o sin guiones): su forma normalizada es la clave del índice, así
+    // "978-84-376-0494-7" y "9788437604947" son el mismo libro. En los
+    // listados se muestra tal como se dio.
     void agregarLibro(string titulo, string autor, string isbn) {
-        libros.push_back(make_shared<Libro>(titulo, autor, isbn));
+        uint64_t clave = normalizarISBN(isbn);
+        if (clave == 0) {
+            cout << "Error: ISBN no válido: " << isbn << endl;
+            return;
+        }
+        if (!altaLibro(titulo, autor, clave, isbn)) {
+            cout << "Error: Libro ya existe" << endl;
+            return;
+        }
+        if (registrarEvento(Evento{EVENTO_ALTA_LIBRO, 0, clave, 0, titulo, autor, isbn})) {
+            compactarSiLleno();
+        }
         cout << "Libro agregado: " << titulo << endl;
     }
 
     void agregarUsuario(string nombre, int id) {
-        usuarios.push_back(make_shared<Usuario>(nombre, id));
+        if (!altaUsuario(nombre, id)) {
+            cout << "Error: Usuario ya registrado" << endl;
+            return;
+        }
+        if (registrarEvento(Evento{EVENTO_ALTA_USUARIO, id, 0, 0, nombre, "", ""})) {
+            compactarSiLleno();
+        }
         cout << "Usuario registrado: " << nombre << endl;
     }
 
-    // Método para realizar préstamo
-    bool prestarLibro(string isbn, int usuarioId) {
-        auto libro = buscarLibro(isbn);
-        auto usuario = buscarUsuario(usuarioId);
+    // Activa la persistencia sobre una biblioteca vacía: recupera el último
+    // snapshot, repite encima el WAL y desde entonces anota cada cambio.
+    // El WAL se compacta en un snapshot nuevo cada umbralEventos eventos.
+    bool activarPersistencia(const string& snapshot, const string& wal,
+                             size_t umbralEventos = 100000) {
+        if (catalogo.size() > 0 || !usuarios.empty()) {
+            cout << "Error: La persistencia debe activarse con la biblioteca vacía" << endl;
+            return false;
+        }
+        lock_guard<mutex> guarda(cerrojoDiario);
+        rutaSnapshot = snapshot;
+        rutaDiario = wal;
+        umbralCompactacion = max<size_t>(1, umbralEventos);
 
-        if (!libro) {
-            cout << "Error: Libro no encontrado" << endl;
+        ArchivoMapeado existente(snapshot);
+        if (existente.estaAbierto() && !cargarSnapshot(snapshot)) {
+            cout << "Error: Snapshot dañado: " << snapshot << endl;
             return false;
         }
+        for (const auto& evento : DiarioEventos::leer(wal)) {
+            repetirEvento(evento);
+        }
+        // Se parte de un snapshot con todo lo recuperado y un WAL vacío
+        // (aún no hay otros hilos)
+        bool correcto = compactarSinBloqueo();
+        persistente.store(diario.estaAbierto(), memory_order_release);
+        return correcto;
+    }
+
+    // Método para compactar el WAL en un snapshot a petición; espera a que
+    // terminen los préstamos y devoluciones en curso
+    bool compactar() {
+        bloquearLibros();
+        bool correcto;
+        {
+            lock_guard<mutex> guarda(cerrojoDiario);
+            correcto = diario.estaAbierto() && compactarSinBloqueo();
+        }
+        desbloquearLibros();
+        return correcto;
+    }
 
+    // Préstamo sin mensajes, seguro entre hilos: el libro se marca como
+    // prestado con una operación atómica antes de anotarlo al usuario, y
+    // se anota en el diario antes de soltar el cerrojo del libro.
+    // El libro debe devolverse en el plazo de dias indicado.
+    ResultadoPrestamo intentarPrestamo(const string& isbn, int usuarioId,
+                                       int dias = PLAZO_PRESTAMO) {
+        int libro = buscarLibro(isbn);
+        if (libro < 0) {
+            return LIBRO_NO_ENCONTRADO;
+        }
+        Usuario* usuario = buscarUsuario(usuarioId);
         if (!usuario) {
-            cout << "Error: Usuario no encontrado" << endl;
-            return false;
+            return USUARIO_NO_ENCONTRADO;
+        }
+        ResultadoPrestamo resultado;
+        bool lleno = false;
+        {
+            lock_guard<mutex> guarda(cerrojoLibro(libro));
+            Evento evento;
+            resultado = aplicarPrestamo(libro, usuario, usuarioId, dias, evento);
+            if (resultado == OPERACION_OK) {
+                lleno = registrarEvento(evento);
+            }
+        }
+        if (lleno) {
+            compactarSiLleno();
+        }
+        return resultado;
+    }
+
+    // Devolución sin mensajes, segura entre hilos: solo el usuario que
+    // tiene el libro puede devolverlo
+    ResultadoPrestamo intentarDevolucion(const string& isbn, int usuarioId) {
+        int libro = buscarLibro(isbn);
+        if (libro < 0) {
+            return LIBRO_NO_ENCONTRADO;
+        }
+        Usuario* usuario = buscarUsuario(usuarioId);
+        if (!usuario) {
+            return USUARIO_NO_ENCONTRADO;
+        }
+        ResultadoPrestamo resultado;
+        bool lleno = false;
+        {
+            lock_guard<mutex> guarda(cerrojoLibro(libro));
+            Evento evento;
+            resultado = aplicarDevolucion(libro, usuario, usuarioId, evento);
+            if (resultado == OPERACION_OK) {
+                lleno = registrarEvento(evento);
+            }
+        }
+        if (lleno) {
+            compactarSiLleno();
+        }
+        return resultado;
+    }
+
+    // Procesa un lote de préstamos y devoluciones (por ejemplo, lo leído por
+    // el buzón de devoluciones) sin mensajes. Cada usuario y cada ISBN se
+    // resuelven una sola vez; después las operaciones se aplican agrupadas
+    // por libro, respetando el orden original dentro de cada libro, y el
+    // diario se vacía una vez para todo el lote. Devuelve el resultado de
+    // cada operación en la misma posición en que llegó.
+    vector<ResultadoPrestamo> procesarLote(const vector<OperacionPrestamo>& operaciones) {
+        size_t n = operaciones.size();
+        vector<ResultadoPrestamo> resultados(n, OPERACION_OK);
+        vector<int> libros(n, -1);
+        vector<Usuario*> lectores(n, nullptr);
+
+        // Pasada de validación: ordenadas por usuario, cada usuario se busca
+        // una vez aunque aparezca en muchas operaciones
+        vector<size_t> orden(n);
+        for (size_t i = 0; i < n; i++) {
+            orden[i] = i;
+        }
+        sort(orden.begin(), orden.end(), [&](size_t a, size_t b) {
+            return operaciones[a].usuarioId < operaciones[b].usuarioId;
+        });
+        for (size_t k = 0; k < n; ) {
+            int id = operaciones[orden[k]].usuarioId;
+            Usuario* usuario = buscarUsuario(id);
+            for (; k < n && operaciones[orden[k]].usuarioId == id; k++) {
+                lectores[orden[k]] = usuario;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            libros[i] = buscarLibro(operaciones[i].isbn);
+            if (libros[i] < 0) {
+                resultados[i] = LIBRO_NO_ENCONTRADO;
+            } else if (!lectores[i]) {
+                resultados[i] = USUARIO_NO_ENCONTRADO;
+            }
+        }
+
+        // Aplicación agrupada por libro: las filas del catálogo se recorren
+        // en orden, un préstamo y su devolución en el mismo lote se
+        // aplican en el orden en que llegaron, y cada grupo se aplica y se
+        // anota con el cerrojo de su libro tomado
+        orden.clear();
+        for (size_t i = 0; i < n; i++) {
+            if (resultados[i] == OPERACION_OK) {
+                orden.push_back(i);
+            }
+        }
+        stable_sort(orden.begin(), orden.end(), [&](size_t a, size_t b) {
+            return libros[a] < libros[b];
+        });
+
+        Evento evento;
+        for (size_t k = 0; k < orden.size(); ) {
+            int libro = libros[orden[k]];
+            lock_guard<mutex> guarda(cerrojoLibro(libro));
+            for (; k < orden.size() && libros[orden[k]] == libro; k++) {
+                size_t i = orden[k];
+                const OperacionPrestamo& op = operaciones[i];
+                if (op.tipo == OP_PRESTAMO) {
+                    resultados[i] = aplicarPrestamo(libro, lectores[i], op.usuarioId, op.dias, evento);
+                } else {
+                    resultados[i] = aplicarDevolucion(libro, lectores[i], op.usuarioId, evento);
+                }
+                if (resultados[i] == OPERACION_OK) {
+                    registrarEvento(evento, false);
+                }
+            }
+        }
+        if (vaciarDiario()) {
+            compactarSiLleno();
+        }
+        return resultados;
+    }
+
+    // Día actual del reloj de la biblioteca
+    uint32_t getDiaActual() const { return diaActual.load(); }
+
+    // Avanza el reloj de la biblioteca y devuelve los préstamos que han
+    // vencido entretanto (cada préstamo se notifica una sola vez), en orden
+    // de vencimiento. Cada rueda se avanza con el cerrojo de sus libros, así
+    // los préstamos de las demás no esperan.
+    vector<PrestamoVencido> avanzarDias(int dias) {
+        vector<PrestamoVencido> resultado;
+        uint32_t dia;
+        {
+            lock_guard<mutex> reloj(cerrojoReloj);
+            dia = diaActual.load() + static_cast<uint32_t>(max(dias, 0));
+            vector<uint32_t> nodos;
+            for (size_t r = 0; r < CERROJOS_LIBROS; r++) {
+                lock_guard<mutex> guarda(cerrojosLibros[r]);
+                nodos.clear();
+                vencimientos[r].avanzar(dia, nodos);
+                for (uint32_t nodo : nodos) {
+                    int libro = static_cast<int>(nodo * CERROJOS_LIBROS + r);
+                    resultado.push_back(PrestamoVencido{catalogo.getTextoISBN(libro),
+                                                        catalogo.getTitulo(libro),
+                                                        vencimientos[r].getEtiqueta(nodo),
+                                                        vencimientos[r].getVence(nodo)});
+                }
+            }
+            diaActual.store(dia);
+        }
+        stable_sort(resultado.begin(), resultado.end(),
+                    [](const PrestamoVencido& a, const PrestamoVencido& b) {
+                        return a.dia < b.dia;
+                    });
+        if (registrarEvento(Evento{EVENTO_AVANCE_RELOJ, 0, 0, dia, "", "", ""})) {
+            compactarSiLleno();
+        }
+        return resultado;
+    }
+
+    // Método para avanzar el reloj mostrando los préstamos vencidos
+    void revisarVencidos(int dias) {
+        vector<PrestamoVencido> vencidos = avanzarDias(dias);
+        cout << "\n=== PRÉSTAMOS VENCIDOS A " << formatearDia(getDiaActual()) << " ===" << endl;
+        if (vencidos.empty()) {
+            cout << "No hay préstamos vencidos" << endl;
+        }
+        for (const auto& v : vencidos) {
+            cout << v.titulo << " (ISBN " << v.isbn << ") - Usuario " << v.usuarioId
+                 << " - Vencía el " << formatearDia(v.dia) << endl;
+        }
+    }
+
+    // Carga masiva desde un CSV (título, autor, ISBN) sin mensajes por libro:
+    // el archivo se proyecta en memoria, se analiza en paralelo (hilos = 0:
+    // uno por núcleo) y después se añaden todos los libros válidos con el
+    // almacenamiento ya reservado. Acepta lo que escribe exportarLibros.
+    ResultadoCarga cargarCSV(const string& ruta, size_t hilos = 0) {
+        ResultadoCarga resultado = {false, 0, 0, 0};
+        ArchivoMapeado archivo(ruta);
+        if (!archivo.estaAbierto()) {
+            return resultado;
+        }
+        resultado.archivoAbierto = true;
+
+        LectorCSV lector(archivo.getDatos(), archivo.getLongitud());
+        vector<RegistroCSV> registros = lector.analizar(resultado.rechazados, hilos);
+
+        catalogo.reservar(catalogo.size() + registros.size());
+        indiceLibros.reservar(indiceLibros.size() + registros.size());
+        for (const auto& r : registros) {
+            if (indiceLibros.buscar(r.isbn) >= 0) {
+                resultado.duplicados++;
+                continue;
+            }
+            altaLibro(LectorCSV::texto(r, 0), LectorCSV::texto(r, 1), r.isbn, LectorCSV::texto(r, 2));
+            resultado.cargados++;
+        }
+        // Una carga masiva no pasa por el WAL: se guarda directamente un snapshot
+        if (resultado.cargados > 0) {
+            compactar();
         }
+        return resultado;
+    }
 
-        if (!libro->estaDisponible()) {
+    // Método para realizar préstamo
+    bool prestarLibro(string isbn, int usuarioId, int dias = PLAZO_PRESTAMO) {
+        switch (intentarPrestamo(isbn, usuarioId, dias)) {
+        case LIBRO_NO_ENCONTRADO:
+            cout << "Error: Libro no encontrado" << endl;
+            return false;
+        case USUARIO_NO_ENCONTRADO:
+            cout << "Error: Usuario no encontrado" << endl;
+            return false;
+        case LIBRO_NO_DISPONIBLE:
             cout << "Error: El libro ya está prestado" << endl;
             return false;
+        default:
+            break;
         }
-
-        libro->prestar();
-        usuario->agregarLibro(isbn);
-        cout << "Préstamo realizado: " << libro->getTitulo() 
-             << " -> " << usuario->getNombre() << endl;
+        cout << "Préstamo realizado: " << catalogo.getTitulo(buscarLibro(isbn))
+             << " -> " << buscarUsuario(usuarioId)->getNombre() << endl;
         return true;
     }
 
     // Método para realizar devolución
     bool devolverLibro(string isbn, int usuarioId) {
-        auto libro = buscarLibro(isbn);
-        auto usuario = buscarUsuario(usuarioId);
-
-        if (!libro || !usuario) {
+        switch (intentarDevolucion(isbn, usuarioId)) {
+        case LIBRO_NO_ENCONTRADO:
+        case USUARIO_NO_ENCONTRADO:
             cout << "Error: Libro o usuario no encontrado" << endl;
             return false;
+        case LIBRO_NO_PRESTADO:
+            cout << "Error: El usuario no tiene ese libro prestado" << endl;
+            return false;
+        default:
+            break;
         }
-
-        libro->devolver();
-        usuario->devolverLibro(isbn);
-        cout << "Devolución realizada: " << libro->getTitulo() 
-             << " <- " << usuario->getNombre() << endl;
+        cout << "Devolución realizada: " << catalogo.getTitulo(buscarLibro(isbn))
+             << " <- " << buscarUsuario(usuarioId)->getNombre() << endl;
         return true;
     }
 
-    // Método para mostrar todos los libros
-    void mostrarLibros() const {
+    // Método para mostrar los libros (todos, solo disponibles o solo prestados)
+    void mostrarLibros(FiltroLibros filtro = TODOS) const {
         cout << "\n=== CATÁLOGO DE LIBROS ===" << endl;
-        for (const auto& libro : libros) {
-            libro->mostrarInfo();
-            cout << "---" << endl;
+        exportarLibros(cout, INFORME_TEXTO, filtro);
+    }
+
+    // Método para exportar el catálogo en texto, CSV o JSON
+    void exportarLibros(ostream& salida, FormatoInforme formato,
+                        FiltroLibros filtro = TODOS) const {
+        Informe informe(salida, formato, COLUMNAS_LIBRO, 4, 1 << 20);
+        catalogo.recorrer(filtro, [this, &informe](size_t fila) {
+            catalogo.escribirInforme(fila, informe);
+        });
+    }
+
+    // Método para buscar libros por palabras (o partes) del título o autor
+    vector<Libro> buscarPorTexto(const string& consulta, size_t maximo = 10) const {
+        asegurarIndiceTexto();
+        vector<Libro> resultado;
+        for (uint32_t fila : indiceTexto.buscar(consulta, maximo)) {
+            resultado.push_back(catalogo.obtenerLibro(fila));
         }
+        return resultado;
     }
 
+    // Método para mostrar el resultado de una búsqueda
+    void mostrarBusqueda(const string& consulta) const {
+        cout << "\n=== BÚSQUEDA: \"" << consulta << "\" ===" << endl;
+        vector<Libro> resultado = buscarPorTexto(consulta);
+        if (resultado.empty()) {
+            cout << "No se encontraron libros" << endl;
+        }
+        Informe informe(cout, INFORME_TEXTO, COLUMNAS_LIBRO, 4);
+        for (const auto& libro : resultado) {
+            libro.escribirInforme(informe);
+        }
+    }
+
+    // Métodos para contar libros según su estado
+    size_t contarDisponibles() const { return catalogo.contarDisponibles(); }
+    size_t contarPrestados() const { return catalogo.contarPrestados(); }
+
     // Método para mostrar todos los usuarios
     void mostrarUsuarios() const {
         cout << "\n=== USUARIOS REGISTRADOS ===" << endl;
+        exportarUsuarios(cout, INFORME_TEXTO);
+    }
+
+    // Método para exportar los usuarios en texto, CSV o JSON
+    void exportarUsuarios(ostream& salida, FormatoInforme formato) const {
+        Informe informe(salida, formato, COLUMNAS_USUARIO, 4, 1 << 20);
         for (const auto& usuario : usuarios) {
-            usuario->mostrarInfo();
-            cout << "---" << endl;
+            usuario->escribirInforme(informe, [this](ManejadorLibro libro, string& texto) {
+                catalogo.anadirISBN(libro, texto);
+            });
         }
     }
 };
 
+// ===== CATÁLOGOS DE PRUEBA =====
+// Escribe un CSV con libros de ISBN válidos (978 + número de libro + dígito
+// de control) y deja sus ISBN en isbns
+void generarCatalogo(const string& ruta, size_t libros, vector<string>& isbns) {
+    FILE* archivo = fopen(ruta.c_str(), "wb");
+    if (!archivo) {
+        return;
+    }
+    fputs("titulo,autor,isbn\n", archivo);
+    isbns.clear();
+    for (size_t i = 0; i < libros; i++) {
+        uint64_t cuerpo = 978000000000ULL + i;
+        isbns.push_back(to_string(cuerpo * 10 + static_cast<uint64_t>(digitoControlISBN13(cuerpo))));
+        fprintf(archivo, "Libro %zu,Autor %zu,%s\n", i, i % 1000, isbns.back().c_str());
+    }
+    fclose(archivo);
+}
+
+// ===== EXPORTAR E IMPORTAR EL CATÁLOGO =====
+// Exporta a CSV un catálogo cuyos títulos y autores llevan comas, comillas
+// y saltos de línea, lo vuelve a cargar en otra biblioteca (troceando el
+// archivo entre varios hilos, aunque la máquina tenga un solo núcleo) y
+// comprueba que exportar las dos da exactamente lo mismo.
+void comprobarIdaYVuelta(size_t libros) {
+    const string ruta = "ida_vuelta_demo.csv";
+    Biblioteca origen;
+    cout.setstate(ios::failbit); // Sin los mensajes de alta
+    for (size_t i = 0; i < libros; i++) {
+        uint64_t cuerpo = 978000000000ULL + i;
+        string isbn = to_string(cuerpo * 10 + static_cast<uint64_t>(digitoControlISBN13(cuerpo)));
+        if (i % 2 == 0) {
+            isbn = isbn.substr(0, 3) + "-" + isbn.substr(3, 9) + "-" + isbn.substr(12);
+        }
+        string titulo = "Obra " + to_string(i);
+        string autor = "Autor " + to_string(i % 1000);
+        if (i % 3 == 0) {
+            titulo += ", \"tomo\" primero\nsegunda línea del título";
+        }
+        if (i % 5 == 0) {
+            autor += "\r\n(edición, \"revisada\")";
+        }
+        origen.agregarLibro(titulo, autor, isbn);
+    }
+    cout.clear();
+    {
+        ofstream archivo(ruta.c_str(), ios::binary);
+        origen.exportarLibros(archivo, INFORME_CSV);
+    }
+
+    Biblioteca destino;
+    ResultadoCarga carga = destino.cargarCSV(ruta, 4);
+    remove(ruta.c_str());
+    ostringstream antes;
+    ostringstream despues;
+    origen.exportarLibros(antes, INFORME_CSV);
+    destino.exportarLibros(despues, INFORME_CSV);
+    cout << "Libros: " << libros << " - Cargados: " << carga.cargados
+         << " - Rechazados: " << carga.rechazados << " - Tamaño: " << antes.str().size() / 1024
+         << " KiB"
+         << (carga.cargados == libros && antes.str() == despues.str()
+                 ? " (coincide con el catálogo exportado)" : " (ERROR)")
+         << endl;
+}
+
+// ===== SIMULACIÓN DE PUESTOS DE AUTOPRÉSTAMO =====
+// Cada hilo es un puesto con su propio usuario que presta y devuelve libros
+// al azar; se reparten operaciones en total entre los puestos y se mide
+// cuántas operaciones (préstamos y devoluciones) se hacen por segundo. Se
+// lleva la cuenta de cuántos usuarios tienen cada libro a la vez: si algún
+// libro llegara a estar prestado dos veces, se detecta.
+void simularPuestos(Biblioteca& biblioteca, const vector<string>& isbns,
+                    const vector<int>& usuarios, int operaciones) {
+    vector<atomic<int>> poseedores(isbns.size());
+    for (auto& p : poseedores) {
+        p.store(0);
+    }
+    atomic<int> prestamos(0);
+    atomic<int> conflictos(0);
+    atomic<long long> realizadas(0);
+
+    vector<thread> puestos;
+    auto inicio = chrono::steady_clock::now();
+    for (size_t h = 0; h < usuarios.size(); h++) {
+        puestos.emplace_back([&, h]() {
+            unsigned semilla = static_cast<unsigned>(h) * 2654435761u + 1;
+            long long propias = 0;
+            for (size_t op = 0; op < operaciones / usuarios.size(); op++) {
+                semilla = semilla * 1103515245u + 12345u;
+                size_t libro = (semilla >> 8) % isbns.size();
+                propias++;
+                if (biblioteca.intentarPrestamo(isbns[libro], usuarios[h]) != OPERACION_OK) {
+                    continue;
+                }
+                prestamos++;
+                if (poseedores[libro].fetch_add(1) != 0) {
+                    conflictos++;
+                }
+                poseedores[libro].fetch_sub(1);
+                biblioteca.intentarDevolucion(isbns[libro], usuarios[h]);
+                propias++;
+            }
+            realizadas += propias;
+        });
+    }
+    for (auto& puesto : puestos) {
+        puesto.join();
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    cout << "Puestos: " << usuarios.size() << " - Operaciones/s: " << fixed << setprecision(0)
+         << realizadas / segundos << " - Préstamos: " << prestamos
+         << " - Libros prestados dos veces: " << conflictos << endl;
+}
+
+// ===== LOTES FRENTE A OPERACIONES SUELTAS =====
+// Presta y después devuelve un libro de cada diez de un catálogo, primero
+// operación a operación y después con dos lotes, y compara los tiempos.
+// Con WAL, cada operación suelta vacía el diario y el lote lo vacía una vez.
+void medirLotes(size_t libros, int usuarios, bool conDiario) {
+    const string snapshot = "lotes_demo.snap";
+    const string wal = "lotes_demo.wal";
+    Biblioteca biblioteca;
+    if (conDiario) {
+        biblioteca.activarPersistencia(snapshot, wal, 10 * libros);
+    }
+    vector<string> isbns;
+    generarCatalogo("lotes_demo.csv", libros, isbns);
+    biblioteca.cargarCSV("lotes_demo.csv");
+    remove("lotes_demo.csv");
+    cout.setstate(ios::failbit); // Sin los mensajes de alta
+    for (int id = 1; id <= usuarios; id++) {
+        biblioteca.agregarUsuario("Lector " + to_string(id), id);
+    }
+    cout.clear();
+
+    vector<OperacionPrestamo> prestamos;
+    vector<OperacionPrestamo> devoluciones;
+    for (size_t i = 0; i < libros; i += 10) {
+        int id = 1 + static_cast<int>(i / 10) % usuarios;
+        prestamos.push_back(OperacionPrestamo{OP_PRESTAMO, isbns[i], id, 14});
+        devoluciones.push_back(OperacionPrestamo{OP_DEVOLUCION, isbns[i], id, 0});
+    }
+
+    size_t correctas = 0;
+    auto inicio = chrono::steady_clock::now();
+    for (const auto& op : prestamos) {
+        correctas += biblioteca.intentarPrestamo(op.isbn, op.usuarioId, op.dias) == OPERACION_OK;
+    }
+    for (const auto& op : devoluciones) {
+        correctas += biblioteca.intentarDevolucion(op.isbn, op.usuarioId) == OPERACION_OK;
+    }
+    auto sueltas = chrono::steady_clock::now();
+    for (const vector<OperacionPrestamo>* lote : {&prestamos, &devoluciones}) {
+        for (ResultadoPrestamo r : biblioteca.procesarLote(*lote)) {
+            correctas += r == OPERACION_OK;
+        }
+    }
+    auto fin = chrono::steady_clock::now();
+
+    auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count();
+    };
+    size_t operaciones = 2 * prestamos.size();
+    cout << (conDiario ? "Con WAL" : "Sin persistencia") << " - Operaciones: " << operaciones
+         << fixed << setprecision(1) << " - Sueltas: " << ms(inicio, sueltas) << " ms"
+         << " - En lote: " << ms(sueltas, fin) << " ms"
+         << (correctas == 2 * operaciones ? "" : " (ERROR)") << endl;
+    remove(snapshot.c_str());
+    remove(wal.c_str());
+}
+
+// ===== RECUPERACIÓN TRAS UN REINICIO =====
+// Con persistencia, carga un catálogo de libros, registra una sucursal y
+// deja en el WAL un préstamo a ella por cada diez libros; después mide cuánto tarda
+// una biblioteca nueva en recuperar ese estado (snapshot + WAL, incluido
+// el snapshot nuevo que se escribe al terminar).
+void medirRecuperacion(size_t libros) {
+    const string snapshot = "recuperacion_demo.snap";
+    const string wal = "recuperacion_demo.wal";
+    size_t prestamos = libros / 10;
+    {
+        Biblioteca anterior;
+        anterior.activarPersistencia(snapshot, wal, libros);
+        vector<string> isbns;
+        generarCatalogo("recuperacion_demo.csv", libros, isbns);
+        anterior.cargarCSV("recuperacion_demo.csv"); // Queda en el snapshot
+        remove("recuperacion_demo.csv");
+        anterior.agregarUsuario("Sucursal " + to_string(libros), 1);
+        vector<OperacionPrestamo> lote;
+        for (size_t i = 0; i < prestamos; i++) {
+            lote.push_back(OperacionPrestamo{OP_PRESTAMO, isbns[i * 10], 1, 14});
+        }
+        anterior.procesarLote(lote); // Queda en el WAL
+    }
+
+    auto inicio = chrono::steady_clock::now();
+    Biblioteca recuperada;
+    bool correcto = recuperada.activarPersistencia(snapshot, wal, libros);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    cout << "Libros: " << libros << " - Préstamos en el WAL: " << prestamos
+         << " - Recuperación: " << fixed << setprecision(1) << ms << " ms"
+         << (correcto && recuperada.contarPrestados() == prestamos ? "" : " (ERROR)") << endl;
+    remove(snapshot.c_str());
+    remove(wal.c_str());
+}
+
+// ===== COMPACTACIÓN CON PRÉSTAMOS EN CURSO =====
+// Estado de una biblioteca para compararlo con otra: los libros en CSV y
+// los usuarios en CSV con los ISBN de cada uno ordenados (el orden de la
+// lista de prestados puede cambiar al recuperarla)
+string estadoBiblioteca(const Biblioteca& biblioteca) {
+    ostringstream libros;
+    ostringstream usuarios;
+    biblioteca.exportarLibros(libros, INFORME_CSV);
+    biblioteca.exportarUsuarios(usuarios, INFORME_CSV);
+    string estado = libros.str();
+    istringstream lineas(usuarios.str());
+    string linea;
+    while (getline(lineas, linea)) {
+        size_t coma = linea.rfind(',');
+        istringstream campo(linea.substr(coma + 1));
+        vector<string> isbns;
+        string isbn;
+        while (campo >> isbn) {
+            isbns.push_back(isbn);
+        }
+        sort(isbns.begin(), isbns.end());
+        estado += linea.substr(0, coma + 1);
+        for (const string& i : isbns) {
+            estado += i + ' ';
+        }
+        estado += '\n';
+    }
+    return estado;
+}
+
+// Varios puestos prestan y devuelven libros de un catálogo pequeño con un
+// umbral de compactación muy bajo, y otro hilo avanza el reloj (vencen
+// préstamos) y compacta a petición sin parar: el snapshot se escribe
+// muchas veces mientras hay préstamos en curso. Al terminar, una biblioteca recuperada desde disco tiene que
+// quedar exactamente igual que la que siguió en memoria.
+void comprobarCompactacion(int puestos, int operaciones) {
+    const string snapshot = "compactacion_demo.snap";
+    const string wal = "compactacion_demo.wal";
+    string esperado;
+    atomic<int> compactaciones(0);
+    {
+        Biblioteca viva;
+        viva.activarPersistencia(snapshot, wal, 64);
+        vector<string> isbns;
+        cout.setstate(ios::failbit); // Sin los mensajes de alta
+        for (int i = 0; i < 200; i++) {
+            uint64_t cuerpo = 978000000000ULL + static_cast<uint64_t>(i);
+            isbns.push_back(to_string(cuerpo * 10 + static_cast<uint64_t>(digitoControlISBN13(cuerpo))));
+            viva.agregarLibro("Obra " + to_string(i), "Autor " + to_string(i % 10), isbns.back());
+        }
+        for (int id = 1; id <= puestos; id++) {
+            viva.agregarUsuario("Puesto " + to_string(id), id);
+        }
+        cout.clear();
+
+        atomic<bool> terminado(false);
+        thread compactador([&]() {
+            while (!terminado) {
+                viva.avanzarDias(1);
+                viva.compactar();
+                compactaciones++;
+            }
+        });
+        vector<thread> hilos;
+        for (int h = 0; h < puestos; h++) {
+            hilos.emplace_back([&, h]() {
+                unsigned semilla = static_cast<unsigned>(h) * 2654435761u + 7;
+                for (int op = 0; op < operaciones / puestos; op++) {
+                    semilla = semilla * 1103515245u + 12345u;
+                    const string& isbn = isbns[(semilla >> 8) % isbns.size()];
+                    // Si el libro es suyo lo devuelve; si no, intenta llevárselo
+                    if (viva.intentarDevolucion(isbn, h + 1) != OPERACION_OK) {
+                        viva.intentarPrestamo(isbn, h + 1);
+                    }
+                }
+            });
+        }
+        for (auto& hilo : hilos) {
+            hilo.join();
+        }
+        terminado = true;
+        compactador.join();
+        esperado = estadoBiblioteca(viva);
+    }
+
+    Biblioteca recuperada;
+    bool correcto = recuperada.activarPersistencia(snapshot, wal, 64);
+    cout << "Puestos: " << puestos << " - Operaciones: " << operaciones
+         << " - Compactaciones a petición: " << compactaciones << " - Prestados: "
+         << recuperada.contarPrestados()
+         << (correcto && estadoBiblioteca(recuperada) == esperado
+                 ? " (la recuperación coincide con la memoria)" : " (ERROR)")
+         << endl;
+    remove(snapshot.c_str());
+    remove(wal.c_str());
+}
+
+// ===== BÚSQUEDA DE TEXTO CON MILLONES DE LIBROS =====
+// Indexa títulos y autores sintéticos: tres palabras comunes de un
+// vocabulario pequeño, una palabra rara (tres sílabas de veinte, unas
+// 8.000 distintas) y un autor con nombre y dos apellidos. Después mide
+// el tiempo medio de varias consultas, desde las que tienen una palabra
+// rara hasta las que solo tienen palabras comunes (esas tienen que
+// puntuar decenas de miles de filas).
+void medirBusquedaTexto(size_t libros) {
+    const char* comunes[] = {"historia", "noche", "ciudad", "tiempo", "amor", "guerra", "mar",
+                             "sombra", "camino", "jardin", "viento", "memoria", "fuego",
+                             "reino", "silencio", "luz", "casa", "tierra", "sueño", "rio"};
+    const char* silabas[] = {"ba", "ce", "di", "fo", "gu", "la", "me", "ni", "po", "ru",
+                             "sa", "te", "vi", "zo", "ca", "de", "li", "mo", "nu", "ra"};
+    const char* nombres[] = {"Gabriel", "Isabel", "Miguel", "Carmen", "Jorge", "Rosa",
+                             "Julio", "Elena", "Pablo", "Laura"};
+    const char* apellidos[] = {"García", "Márquez", "Pérez", "López", "Martín", "Sánchez",
+                               "Gómez", "Díaz", "Romero", "Navarro", "Torres", "Ruiz"};
+    unsigned semilla = 12345;
+    auto azar = [&semilla](unsigned n) {
+        semilla = semilla * 1103515245u + 12345u;
+        return (semilla >> 8) % n;
+    };
+
+    IndiceTexto indice;
+    auto inicio = chrono::steady_clock::now();
+    for (size_t fila = 0; fila < libros; fila++) {
+        string titulo = comunes[azar(20)];
+        titulo += ' ';
+        titulo += comunes[azar(20)];
+        titulo += ' ';
+        for (int s = 0; s < 3; s++) {
+            titulo += silabas[azar(20)];
+        }
+        string autor = string(nombres[azar(10)]) + ' ' + apellidos[azar(12)] + ' ' +
+                       apellidos[azar(12)];
+        indice.agregar(static_cast<uint32_t>(fila), titulo, autor);
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cout << "Libros: " << libros << " - Indexado: " << fixed << setprecision(1) << segundos
+         << " s" << endl;
+
+    const char* consultas[] = {"bamedi", "bamedi garcia", "memoria ruca", "nuteli jorge",
+                               "garcia marquez isabel", "historia noche"};
+    for (const char* consulta : consultas) {
+        const int REPETICIONES = 20;
+        size_t encontrados = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (int r = 0; r < REPETICIONES; r++) {
+            encontrados = indice.buscar(consulta, 10).size();
+        }
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count() /
+                    REPETICIONES;
+        cout << "  \"" << consulta << "\": " << setprecision(1) << us << " us ("
+             << encontrados << " resultados)" << endl;
+    }
+}
+
 // ===== FUNCIÓN MAIN - DEMOSTRACIÓN =====
 int main() {
     // Crear una biblioteca
@@ -210,6 +2973,26 @@ int main() {
     biblioteca.agregarLibro("El Quijote", "Miguel de Cervantes", "978-84-376-0494-7");
     biblioteca.agregarLibro("Cien Años de Soledad", "Gabriel García Márquez", "978-84-376-0495-4");
     biblioteca.agregarLibro("1984", "George Orwell", "978-84-376-0496-1");
+    biblioteca.agregarLibro("El Quijote", "Miguel de Cervantes", "9788437604947"); // Duplicado
+
+    // Carga masiva desde un archivo CSV
+    cout << "\n=== CARGANDO CATÁLOGO DESDE CSV ===" << endl;
+    {
+        ofstream csv("catalogo_demo.csv");
+        csv << "titulo,autor,isbn\n"
+            << "\"Rayuela\",Julio Cortázar,978-84-376-0474-9\n"
+            << "\"Niebla, nivola\",Miguel de Unamuno,9788437604848\n"
+            << "Ficciones,Jorge Luis Borges,978-84-376-0000-1\n"  // Dígito de control erróneo
+            << "1984,George Orwell,978-84-376-0496-1\n";          // Ya estaba en el catálogo
+    }
+    ResultadoCarga carga = biblioteca.cargarCSV("catalogo_demo.csv");
+    remove("catalogo_demo.csv");
+    cout << "Cargados: " << carga.cargados << " - Rechazados: " << carga.rechazados
+         << " - Duplicados: " << carga.duplicados << endl;
+
+    // Un catálogo exportado a CSV se vuelve a cargar tal cual, aunque sus
+    // campos tengan saltos de línea
+    comprobarIdaYVuelta(60000);
 
     // Registrar usuarios
     cout << "\n=== REGISTRANDO USUARIOS ===" << endl;
@@ -223,8 +3006,25 @@ int main() {
 
     // Mostrar estado actual
     biblioteca.mostrarLibros();
+    cout << "Disponibles: " << biblioteca.contarDisponibles()
+         << " - Prestados: " << biblioteca.contarPrestados() << endl;
+    biblioteca.mostrarLibros(PRESTADOS); // Solo los libros prestados
     biblioteca.mostrarUsuarios();
 
+    // Exportar listados para otras aplicaciones
+    cout << "\n=== EXPORTACIÓN CSV (PRESTADOS) ===" << endl;
+    biblioteca.exportarLibros(cout, INFORME_CSV, PRESTADOS);
+    cout << "\n=== EXPORTACIÓN JSON (USUARIOS) ===" << endl;
+    biblioteca.exportarUsuarios(cout, INFORME_JSON);
+
+    // Buscar por texto (sin distinguir tildes ni mayúsculas)
+    biblioteca.mostrarBusqueda("garcia marquez");
+    biblioteca.mostrarBusqueda("quij");
+
+    // La misma búsqueda sobre millones de libros
+    cout << "\n=== BÚSQUEDA CON MILLONES DE LIBROS ===" << endl;
+    medirBusquedaTexto(2000000);
+
     // Realizar devolución
     cout << "\n=== REALIZANDO DEVOLUCIÓN ===" << endl;
     biblioteca.devolverLibro("978-84-376-0494-7", 1);
@@ -232,6 +3032,85 @@ int main() {
     // Mostrar estado final
     biblioteca.mostrarLibros();
 
+    // Pasan 15 días: el préstamo pendiente (plazo de 14 días) ha vencido
+    biblioteca.revisarVencidos(15);
+
+    // Lote del buzón de devoluciones: un único resultado por operación
+    cout << "\n=== PROCESANDO LOTE ===" << endl;
+    vector<OperacionPrestamo> lote = {
+        {OP_DEVOLUCION, "978-84-376-0495-4", 2, 0},
+        {OP_PRESTAMO, "978-84-376-0496-1", 1, Biblioteca::PLAZO_PRESTAMO},
+        {OP_PRESTAMO, "978-84-376-0496-1", 2, Biblioteca::PLAZO_PRESTAMO},
+        {OP_DEVOLUCION, "978-84-376-0496-1", 1, 0},
+        {OP_PRESTAMO, "978-00-000-0000-0", 1, Biblioteca::PLAZO_PRESTAMO},
+        {OP_DEVOLUCION, "978-84-376-0494-7", 99, 0}
+    };
+    vector<ResultadoPrestamo> resultados = biblioteca.procesarLote(lote);
+    for (size_t i = 0; i < lote.size(); i++) {
+        cout << (lote[i].tipo == OP_PRESTAMO ? "Préstamo   " : "Devolución ")
+             << lote[i].isbn << " (usuario " << lote[i].usuarioId << "): "
+             << nombreResultado(resultados[i]) << endl;
+    }
+
+    // El mismo trabajo operación a operación y en lotes
+    medirLotes(200000, 1000, false);
+    medirLotes(200000, 1000, true);
+
+    // Préstamos concurrentes desde varios puestos, sobre los tres libros
+    // de la demo (mucha competencia) y sobre un catálogo de 10.000 libros
+    cout << "\n=== PUESTOS DE AUTOPRÉSTAMO ===" << endl;
+    vector<int> puestos;
+    for (int id = 101; id <= 108; id++) {
+        biblioteca.agregarUsuario("Puesto " + to_string(id), id);
+        puestos.push_back(id);
+    }
+    simularPuestos(biblioteca,
+                   {"978-84-376-0494-7", "978-84-376-0495-4", "978-84-376-0496-1"},
+                   puestos, 160000);
+    {
+        Biblioteca red;
+        vector<string> isbns;
+        generarCatalogo("puestos_demo.csv", 10000, isbns);
+        red.cargarCSV("puestos_demo.csv");
+        remove("puestos_demo.csv");
+        vector<int> usuarios;
+        for (int id = 1; id <= 8; id++) {
+            red.agregarUsuario("Puesto " + to_string(id), id);
+            usuarios.push_back(id);
+        }
+        for (size_t n = 1; n <= usuarios.size(); n *= 2) {
+            simularPuestos(red, isbns, vector<int>(usuarios.begin(), usuarios.begin() + n), 800000);
+        }
+    }
+
+    // Persistencia: los cambios van al WAL y sobreviven a un reinicio
+    cout << "\n=== PERSISTENCIA Y REINICIO ===" << endl;
+    {
+        Biblioteca anterior;
+        anterior.activarPersistencia("biblioteca.snap", "biblioteca.wal");
+        anterior.agregarLibro("La Regenta", "Leopoldo Alas Clarín", "978-84-376-0500-5");
+        anterior.agregarLibro("Fortunata y Jacinta", "Benito Pérez Galdós", "978-84-376-0501-2");
+        anterior.agregarUsuario("Lucía Romero", 7);
+        anterior.prestarLibro("978-84-376-0501-2", 7);
+    } // Aquí la biblioteca se destruye como si el programa terminara
+
+    Biblioteca recuperada;
+    recuperada.activarPersistencia("biblioteca.snap", "biblioteca.wal");
+    recuperada.mostrarLibros(PRESTADOS);
+    recuperada.mostrarUsuarios();
+    remove("biblioteca.snap");
+    remove("biblioteca.wal");
+
+    // Compactar mientras otros hilos prestan no debe perder ni duplicar préstamos
+    cout << "\n=== COMPACTACIÓN CON PRÉSTAMOS EN CURSO ===" << endl;
+    comprobarCompactacion(4, 200000);
+
+    // Tiempo de recuperación según el tamaño del catálogo
+    cout << "\n=== TIEMPO DE RECUPERACIÓN ===" << endl;
+    for (size_t libros = 10000; libros <= 1000000; libros *= 10) {
+        medirRecuperacion(libros);
+    }
+
     return 0;
 }
 
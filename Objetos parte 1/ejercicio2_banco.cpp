@@ -22,185 +22,2203 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <type_traits>
 #include <ctime>
 #include <iomanip>
-#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#if defined(_WIN32)
+#include <iterator>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // ===== ENUMS =====
 enum TipoCuenta { AHORROS, CORRIENTE };
-enum TipoTransaccion { DEPOSITO, RETIRO };
+enum TipoTransaccion {
+    DEPOSITO,
+    RETIRO,
+    TRANSFERENCIA_ENVIADA,
+    TRANSFERENCIA_RECIBIDA,
+    INTERES,  // Intereses de una cuenta de ahorros
+    COMISION  // Comisión de mantenimiento de una cuenta corriente
+};
+
+// Resultado de una operación sobre cuentas
+enum ResultadoOperacion {
+    OPERACION_OK,
+    CUENTA_NO_ENCONTRADA,
+    MONTO_INVALIDO,
+    SALDO_INSUFICIENTE,
+    MISMA_CUENTA,
+    DESBORDAMIENTO,
+    FORMATO_INVALIDO,
+    ERROR_PERSISTENCIA  // Aplicada en memoria, pero el WAL no llegó al disco
+};
+
+// Nombre de cada resultado, para los archivos de resultados
+const char* nombreResultado(ResultadoOperacion r) {
+    switch (r) {
+    case OPERACION_OK:         return "OK";
+    case CUENTA_NO_ENCONTRADA: return "CUENTA_NO_ENCONTRADA";
+    case MONTO_INVALIDO:       return "MONTO_INVALIDO";
+    case SALDO_INSUFICIENTE:   return "SALDO_INSUFICIENTE";
+    case MISMA_CUENTA:         return "MISMA_CUENTA";
+    case DESBORDAMIENTO:       return "DESBORDAMIENTO";
+    case FORMATO_INVALIDO:     return "FORMATO_INVALIDO";
+    case ERROR_PERSISTENCIA:   return "ERROR_PERSISTENCIA";
+    }
+    return "DESCONOCIDO";
+}
+
+// Indica si un tipo de transacción entra dinero en la cuenta
+inline bool esAbono(TipoTransaccion tipo) {
+    return tipo == DEPOSITO || tipo == TRANSFERENCIA_RECIBIDA || tipo == INTERES;
+}
+
+// ===== CLASE DINERO =====
+// Importe en céntimos como entero de 64 bits: sumas y restas exactas, sin
+// el error de redondeo de double. Las operaciones que pueden desbordar
+// devuelven false y dejan el valor como estaba.
+class Dinero {
+private:
+    int64_t centimos;
+
+public:
+    Dinero() : centimos(0) {}
+    explicit Dinero(int64_t c) : centimos(c) {}
+
+    // Importe escrito con decimales (1000.50); se redondea al céntimo
+    static Dinero importe(double valor) {
+        return Dinero(static_cast<int64_t>(llround(valor * 100.0)));
+    }
+
+    // Lee un importe como "1234", "1234.5" o "-12.34" sin pasar por double.
+    // Devuelve false si el texto no es un importe o no cabe en 64 bits.
+    static bool leer(const char* texto, size_t longitud, Dinero& resultado) {
+        size_t i = 0;
+        bool negativo = (longitud > 0 && texto[0] == '-');
+        if (negativo || (longitud > 0 && texto[0] == '+')) {
+            i++;
+        }
+        uint64_t valor = 0;
+        size_t digitos = 0;
+        for (; i < longitud && texto[i] >= '0' && texto[i] <= '9'; i++, digitos++) {
+            if (valor > (static_cast<uint64_t>(INT64_MAX) - 9) / 10) {
+                return false;
+            }
+            valor = valor * 10 + static_cast<uint64_t>(texto[i] - '0');
+        }
+        int decimales = 0;
+        if (i < longitud && texto[i] == '.') {
+            for (i++; i < longitud && texto[i] >= '0' && texto[i] <= '9'; i++, digitos++) {
+                if (decimales == 2) {
+                    return false; // Más precisión que el céntimo
+                }
+                valor = valor * 10 + static_cast<uint64_t>(texto[i] - '0');
+                decimales++;
+            }
+        }
+        if (i != longitud || digitos == 0) {
+            return false;
+        }
+        for (; decimales < 2; decimales++) {
+            if (valor > static_cast<uint64_t>(INT64_MAX) / 10) {
+                return false;
+            }
+            valor *= 10;
+        }
+        if (valor > static_cast<uint64_t>(INT64_MAX)) {
+            return false;
+        }
+        int64_t c = static_cast<int64_t>(valor);
+        resultado = Dinero(negativo ? -c : c);
+        return true;
+    }
+
+    int64_t getCentimos() const { return centimos; }
+
+    // Suma otro importe; false si el resultado no cabe en 64 bits
+    bool sumar(Dinero otro) {
+        int64_t r;
+#if defined(__GNUC__)
+        if (__builtin_add_overflow(centimos, otro.centimos, &r)) {
+            return false;
+        }
+#else
+        if ((otro.centimos > 0 && centimos > INT64_MAX - otro.centimos) ||
+            (otro.centimos < 0 && centimos < INT64_MIN - otro.centimos)) {
+            return false;
+        }
+        r = centimos + otro.centimos;
+#endif
+        centimos = r;
+        return true;
+    }
+
+    // Resta otro importe; false si el resultado no cabe en 64 bits
+    bool restar(Dinero otro) {
+        int64_t r;
+#if defined(__GNUC__)
+        if (__builtin_sub_overflow(centimos, otro.centimos, &r)) {
+            return false;
+        }
+#else
+        if ((otro.centimos < 0 && centimos > INT64_MAX + otro.centimos) ||
+            (otro.centimos > 0 && centimos < INT64_MIN + otro.centimos)) {
+            return false;
+        }
+        r = centimos - otro.centimos;
+#endif
+        centimos = r;
+        return true;
+    }
+
+    bool operator==(Dinero otro) const { return centimos == otro.centimos; }
+    bool operator!=(Dinero otro) const { return centimos != otro.centimos; }
+    bool operator<(Dinero otro) const { return centimos < otro.centimos; }
+    bool operator<=(Dinero otro) const { return centimos <= otro.centimos; }
+    bool operator>(Dinero otro) const { return centimos > otro.centimos; }
+    bool operator>=(Dinero otro) const { return centimos >= otro.centimos; }
+
+    // Se muestra con dos decimales, como 1234.56
+    friend ostream& operator<<(ostream& salida, Dinero d) {
+        uint64_t absoluto = (d.centimos < 0) ? 0 - static_cast<uint64_t>(d.centimos)
+                                             : static_cast<uint64_t>(d.centimos);
+        char texto[32];
+        snprintf(texto, sizeof(texto), "%s%llu.%02llu", (d.centimos < 0) ? "-" : "",
+                 static_cast<unsigned long long>(absoluto / 100),
+                 static_cast<unsigned long long>(absoluto % 100));
+        return salida << texto;
+    }
+};
+
+// ===== SUMA VECTORIZADA DE CÉNTIMOS =====
+// Suma de una columna de enteros de 64 bits con AVX2 o SSE2 cuando la CPU
+// los tiene, y un bucle normal si no. La suma es módulo 2^64: si el total
+// real cabe en 64 bits el resultado es exacto aunque algún parcial no.
+inline uint64_t sumarEscalar(const int64_t* valores, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += static_cast<uint64_t>(valores[i]);
+    }
+    return total;
+}
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SUMA_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUMA_AVX2 1
+#endif
+
+#if defined(SUMA_SSE2)
+inline uint64_t sumarSSE2(const int64_t* valores, size_t n) {
+    __m128i a = _mm_setzero_si128();
+    __m128i b = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a = _mm_add_epi64(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(valores + i)));
+        b = _mm_add_epi64(b, _mm_loadu_si128(reinterpret_cast<const __m128i*>(valores + i + 2)));
+    }
+    uint64_t partes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(partes), _mm_add_epi64(a, b));
+    return partes[0] + partes[1] + sumarEscalar(valores + i, n - i);
+}
+#endif
+
+#if defined(SUMA_AVX2)
+__attribute__((target("avx2")))
+inline uint64_t sumarAVX2(const int64_t* valores, size_t n) {
+    __m256i a = _mm256_setzero_si256();
+    __m256i b = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a = _mm256_add_epi64(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(valores + i)));
+        b = _mm256_add_epi64(b, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(valores + i + 4)));
+    }
+    uint64_t partes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(partes), _mm256_add_epi64(a, b));
+    return partes[0] + partes[1] + partes[2] + partes[3] + sumarEscalar(valores + i, n - i);
+}
+#endif
+
+inline uint64_t sumarCentimos(const int64_t* valores, size_t n) {
+#if defined(SUMA_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        return sumarAVX2(valores, n);
+    }
+#endif
+#if defined(SUMA_SSE2)
+    return sumarSSE2(valores, n);
+#else
+    return sumarEscalar(valores, n);
+#endif
+}
+
+// ===== INTERESES VECTORIZADOS =====
+// Interés de una columna de saldos en céntimos: saldo × tasa redondeado
+// al céntimo (las mitades al par). Con AVX2 o SSE2 el saldo pasa a double
+// sin instrucciones de conversión (se le pone el exponente de 2^52 y se
+// resta 2^52) y el redondeo se hace sumando 2^52; vale para saldos entre
+// 0 y 2^52 céntimos, y los que se salen de ahí van por el bucle escalar,
+// que hace las mismas operaciones y da exactamente el mismo resultado.
+const uint64_t BITS_FUERA_DE_RANGO = 0xFFF0000000000000ULL; // Saldo < 0 o >= 2^52
+const double DOS_A_LA_52 = 4503599627370496.0;
+
+inline void calcularInteresesEscalar(const int64_t* saldos, int64_t* intereses, size_t n,
+                                     double tasa) {
+    for (size_t i = 0; i < n; i++) {
+        intereses[i] = static_cast<int64_t>(nearbyint(static_cast<double>(saldos[i]) * tasa));
+    }
+}
+
+#if defined(SUMA_SSE2)
+inline void calcularInteresesSSE2(const int64_t* saldos, int64_t* intereses, size_t n,
+                                  double tasa) {
+    const __m128i exponente = _mm_set1_epi64x(0x4330000000000000LL);
+    const __m128i fuera = _mm_set1_epi64x(static_cast<int64_t>(BITS_FUERA_DE_RANGO));
+    const __m128i mantisa = _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m128d desplazamiento = _mm_set1_pd(DOS_A_LA_52);
+    const __m128d factor = _mm_set1_pd(tasa);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(saldos + i));
+        __m128i altos = _mm_and_si128(s, fuera);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(altos, _mm_setzero_si128())) != 0xFFFF) {
+            calcularInteresesEscalar(saldos + i, intereses + i, 2, tasa);
+            continue;
+        }
+        __m128d d = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(s, exponente)), desplazamiento);
+        __m128d r = _mm_add_pd(_mm_mul_pd(d, factor), desplazamiento);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(intereses + i),
+                         _mm_and_si128(_mm_castpd_si128(r), mantisa));
+    }
+    calcularInteresesEscalar(saldos + i, intereses + i, n - i, tasa);
+}
+#endif
+
+#if defined(SUMA_AVX2)
+__attribute__((target("avx2")))
+inline void calcularInteresesAVX2(const int64_t* saldos, int64_t* intereses, size_t n,
+                                  double tasa) {
+    const __m256i exponente = _mm256_set1_epi64x(0x4330000000000000LL);
+    const __m256i fuera = _mm256_set1_epi64x(static_cast<int64_t>(BITS_FUERA_DE_RANGO));
+    const __m256i mantisa = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m256d desplazamiento = _mm256_set1_pd(DOS_A_LA_52);
+    const __m256d factor = _mm256_set1_pd(tasa);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(saldos + i));
+        if (!_mm256_testz_si256(s, fuera)) {
+            calcularInteresesEscalar(saldos + i, intereses + i, 4, tasa);
+            continue;
+        }
+        __m256d d = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(s, exponente)),
+                                  desplazamiento);
+        __m256d r = _mm256_add_pd(_mm256_mul_pd(d, factor), desplazamiento);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(intereses + i),
+                            _mm256_and_si256(_mm256_castpd_si256(r), mantisa));
+    }
+    calcularInteresesEscalar(saldos + i, intereses + i, n - i, tasa);
+}
+#endif
+
+// tasa debe estar entre 0 y 1
+inline void calcularIntereses(const int64_t* saldos, int64_t* intereses, size_t n, double tasa) {
+#if defined(SUMA_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        calcularInteresesAVX2(saldos, intereses, n, tasa);
+        return;
+    }
+#endif
+#if defined(SUMA_SSE2)
+    calcularInteresesSSE2(saldos, intereses, n, tasa);
+#else
+    calcularInteresesEscalar(saldos, intereses, n, tasa);
+#endif
+}
+
+// ===== MARCAS DE TIEMPO =====
+// Instante en segundos desde 1970-01-01 (UTC). Se toma con time(), sin
+// localtime ni flujos, y solo se convierte a texto cuando se muestra.
+typedef int64_t MarcaTiempo;
+
+const size_t LONGITUD_FECHA = 20; // "AAAA-MM-DD HH:MM:SS" más el '\0'
+
+inline MarcaTiempo marcaActual() {
+    return static_cast<MarcaTiempo>(time(nullptr));
+}
+
+// Escribe la marca en hora local en destino (LONGITUD_FECHA bytes). Cada
+// hilo guarda el texto del último segundo formateado: las operaciones
+// hechas en el mismo segundo reutilizan la fecha sin llamar a localtime_r.
+inline void formatearMarca(MarcaTiempo marca, char* destino) {
+    static thread_local MarcaTiempo segundo = INT64_MIN;
+    static thread_local char texto[LONGITUD_FECHA];
+    if (marca != segundo) {
+        time_t t = static_cast<time_t>(marca);
+        tm partes;
+#if defined(_WIN32)
+        localtime_s(&partes, &t);
+#else
+        localtime_r(&t, &partes);
+#endif
+        strftime(texto, sizeof(texto), "%Y-%m-%d %H:%M:%S", &partes);
+        segundo = marca;
+    }
+    memcpy(destino, texto, LONGITUD_FECHA);
+}
+
+inline string formatearMarca(MarcaTiempo marca) {
+    char texto[LONGITUD_FECHA];
+    formatearMarca(marca, texto);
+    return texto;
+}
 
 // ===== CLASE TRANSACCION =====
 class Transaccion {
 private:
     int id;
     TipoTransaccion tipo;
-    double monto;
-    string fecha;
+    Dinero monto;
+    MarcaTiempo marca; // Momento de la transacción; se formatea al mostrarla
     int cuentaId;
 
 public:
-    Transaccion(int i, TipoTransaccion t, double m, int cId) 
-        : id(i), tipo(t), monto(m), cuentaId(cId) {
-        // Obtener fecha actual
-        time_t ahora = time(0);
-        tm* tiempo = localtime(&ahora);
-        stringstream ss;
-        ss << put_time(tiempo, "%Y-%m-%d %H:%M:%S");
-        fecha = ss.str();
-    }
+    Transaccion(int i, TipoTransaccion t, Dinero m, int cId) 
+        : id(i), tipo(t), monto(m), marca(marcaActual()), cuentaId(cId) {}
+
+    // Constructor a partir de un registro ya guardado en el historial
+    Transaccion(int i, TipoTransaccion t, Dinero m, MarcaTiempo mt, int cId)
+        : id(i), tipo(t), monto(m), marca(mt), cuentaId(cId) {}
 
     int getId() const { return id; }
     TipoTransaccion getTipo() const { return tipo; }
-    double getMonto() const { return monto; }
-    string getFecha() const { return fecha; }
+    Dinero getMonto() const { return monto; }
+    MarcaTiempo getMarca() const { return marca; }
+    string getFecha() const { return formatearMarca(marca); }
     int getCuentaId() const { return cuentaId; }
 
     void mostrarInfo() const {
-        string tipoStr = (tipo == DEPOSITO) ? "DEPÓSITO" : "RETIRO";
+        string tipoStr;
+        switch (tipo) {
+        case DEPOSITO:               tipoStr = "DEPÓSITO"; break;
+        case RETIRO:                 tipoStr = "RETIRO"; break;
+        case TRANSFERENCIA_ENVIADA:  tipoStr = "TRANSFERENCIA ENVIADA"; break;
+        case TRANSFERENCIA_RECIBIDA: tipoStr = "TRANSFERENCIA RECIBIDA"; break;
+        case INTERES:                tipoStr = "INTERÉS"; break;
+        case COMISION:               tipoStr = "COMISIÓN"; break;
+        }
+        char fecha[LONGITUD_FECHA];
+        formatearMarca(marca, fecha);
         cout << "[" << fecha << "] " << tipoStr 
-             << " - Monto: $" << fixed << setprecision(2) << monto 
+             << " - Monto: $" << monto
              << " - Cuenta: " << cuentaId << endl;
     }
 };
 
-// ===== CLASE CUENTA =====
-class Cuenta {
+// ===== FUNCIONES AUXILIARES DE ARCHIVOS BINARIOS =====
+// Los archivos binarios (snapshot y WAL) usan la representación nativa de
+// la máquina: sirven para reiniciar en el mismo equipo, no para intercambio.
+
+template <typename T>
+void escribirValor(FILE* archivo, const T& valor) {
+    fwrite(&valor, sizeof(T), 1, archivo);
+}
+
+template <typename T>
+void escribirVector(FILE* archivo, const vector<T>& v) {
+    escribirValor<uint64_t>(archivo, v.size());
+    if (!v.empty()) {
+        fwrite(v.data(), sizeof(T), v.size(), archivo);
+    }
+}
+
+inline void escribirTexto(FILE* archivo, const string& texto) {
+    escribirValor<uint64_t>(archivo, texto.size());
+    fwrite(texto.data(), 1, texto.size(), archivo);
+}
+
+// Fuerza que los datos escritos lleguen al disco
+inline bool sincronizarArchivo(FILE* archivo) {
+    if (fflush(archivo) != 0) {
+        return false;
+    }
+#if defined(_WIN32)
+    return _commit(_fileno(archivo)) == 0;
+#else
+    return fsync(fileno(archivo)) == 0;
+#endif
+}
+
+// Sincroniza el directorio del archivo para que un rename() sobreviva a
+// una caída (en Windows basta con el rename)
+inline bool sincronizarDirectorio(const string& ruta) {
+#if defined(_WIN32)
+    (void)ruta;
+    return true;
+#else
+    size_t barra = ruta.find_last_of('/');
+    string directorio = (barra == string::npos) ? "." : ruta.substr(0, barra + 1);
+    int fd = open(directorio.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool correcto = fsync(fd) == 0;
+    close(fd);
+    return correcto;
+#endif
+}
+
+// Lee valores de un bloque de memoria comprobando que no se sale de él
+class LectorBinario {
 private:
-    int numero;
-    TipoCuenta tipo;
-    double saldo;
-    string titular;
-    vector<shared_ptr<Transaccion>> transacciones;
-    static int contadorCuentas;
+    const char* p;
+    const char* fin;
+
+public:
+    LectorBinario(const char* datos, size_t longitud) : p(datos), fin(datos + longitud) {}
+
+    size_t restantes() const { return static_cast<size_t>(fin - p); }
+    const char* posicion() const { return p; }
+
+    template <typename T>
+    bool leer(T& valor) {
+        if (restantes() < sizeof(T)) {
+            return false;
+        }
+        memcpy(&valor, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool leerVector(vector<T>& v) {
+        uint64_t n;
+        if (!leer(n) || n > restantes() / sizeof(T)) {
+            return false;
+        }
+        v.resize(static_cast<size_t>(n));
+        if (n > 0) {
+            memcpy(&v[0], p, static_cast<size_t>(n) * sizeof(T));
+        }
+        p += n * sizeof(T);
+        return true;
+    }
+
+    bool leerBytes(string& texto, size_t n) {
+        if (n > restantes()) {
+            return false;
+        }
+        texto.assign(p, n);
+        p += n;
+        return true;
+    }
+
+    bool leerTexto(string& texto) {
+        uint64_t n;
+        return leer(n) && n <= restantes() && leerBytes(texto, static_cast<size_t>(n));
+    }
+
+    bool saltar(size_t n) {
+        if (n > restantes()) {
+            return false;
+        }
+        p += n;
+        return true;
+    }
+};
+
+// CRC-32 (el de zip y Ethernet) para detectar registros dañados
+struct TablaCRC32 {
+    uint32_t valores[256];
+
+    TablaCRC32() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            valores[i] = c;
+        }
+    }
+};
+
+inline uint32_t calcularCRC32(const char* datos, size_t longitud) {
+    static const TablaCRC32 tabla;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < longitud; i++) {
+        crc = tabla.valores[(crc ^ static_cast<unsigned char>(datos[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// ===== CLASE ARCHIVOMAPEADO =====
+// Proyecta un archivo completo en memoria (mmap) para leerlo sin copias.
+// En Windows se lee el archivo entero a memoria.
+class ArchivoMapeado {
+private:
+    const char* datos;
+    size_t longitud;
+    bool abierto;
+#if defined(_WIN32)
+    string contenido;
+#else
+    void* mapa;
+#endif
+
+    ArchivoMapeado(const ArchivoMapeado&);            // No copiable
+    ArchivoMapeado& operator=(const ArchivoMapeado&);
+
+public:
+    explicit ArchivoMapeado(const string& ruta) : datos(""), longitud(0), abierto(false) {
+#if defined(_WIN32)
+        ifstream archivo(ruta.c_str(), ios::binary);
+        if (archivo) {
+            contenido.assign(istreambuf_iterator<char>(archivo), istreambuf_iterator<char>());
+            datos = contenido.data();
+            longitud = contenido.size();
+            abierto = true;
+        }
+#else
+        mapa = nullptr;
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            abierto = true;
+            longitud = static_cast<size_t>(info.st_size);
+            if (longitud > 0) {
+                mapa = mmap(nullptr, longitud, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapa == MAP_FAILED) {
+                    mapa = nullptr;
+                    longitud = 0;
+                    abierto = false;
+                } else {
+                    madvise(mapa, longitud, MADV_SEQUENTIAL);
+                    datos = static_cast<const char*>(mapa);
+                }
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~ArchivoMapeado() {
+#if !defined(_WIN32)
+        if (mapa) {
+            munmap(mapa, longitud);
+        }
+#endif
+    }
+
+    bool estaAbierto() const { return abierto; }
+    const char* getDatos() const { return datos; }
+    size_t getLongitud() const { return longitud; }
+};
+
+// ===== CLASE REGISTROBANCO =====
+// WAL del banco: cada alta y cada movimiento se anota antes de dar la
+// operación por hecha. Registro: longitud (4 bytes), CRC-32 (4 bytes) y
+// datos; al recuperar, la lectura se detiene en el primer registro cortado
+// o con el CRC incorrecto.
+// Confirmación en grupo: anotar() solo copia el evento a un búfer en
+// memoria; esperarDurable() garantiza que ha llegado al disco. El primer
+// hilo que espera escribe y sincroniza todo lo acumulado de una vez, y los
+// que llegan mientras tanto esperan a ese fsync o al siguiente, así muchas
+// operaciones comparten cada fsync. Con una ventana mayor que cero el hilo
+// que escribe espera ese tiempo antes para reunir más operaciones.
+// Si una escritura o un fsync falla, el WAL queda marcado como fallido:
+// nada de lo pendiente se da por durable y esperarDurable() devuelve false.
+// Lo que hubiera en memoria sin llegar al disco se pierde: al reiniciar se
+// recupera solo lo que sí se confirmó.
+enum TipoEventoBanco {
+    EVENTO_ALTA_CLIENTE = 1,
+    EVENTO_ALTA_CUENTA,
+    EVENTO_DEPOSITO,
+    EVENTO_RETIRO,
+    EVENTO_TRANSFERENCIA,
+    EVENTO_BAJA_CUENTA,
+    EVENTO_INTERES,
+    EVENTO_COMISION
+};
+
+struct EventoBanco {
+    TipoEventoBanco tipo;
+    uint64_t secuencia; // La asigna el WAL, empezando en 1
+    int32_t cuenta;     // Cuenta afectada (origen en las transferencias)
+    int32_t extra;      // Cuenta destino o, en las altas de cuenta, su TipoCuenta
+    int64_t centimos;   // Importe o, en las altas y bajas de cuenta, el último número dado
+    MarcaTiempo marca;
+    string nombre;
+    string dni;
+};
+
+class RegistroBanco {
+private:
+    FILE* archivo;
+    mutex cerrojo;
+    condition_variable aviso;
+    string pendiente;   // Registros anotados que aún no se han escrito
+    uint64_t siguiente; // Secuencia del próximo evento
+    uint64_t durable;   // Última secuencia que ya está en disco
+    bool escribiendo;   // Un hilo está escribiendo y sincronizando
+    bool fallo;         // Alguna escritura o sincronización ha fallado
+    unsigned ventanaMicros;
+    uint64_t eventos;
+    uint64_t grupos;    // Número de fsync hechos
+
+    static const size_t TAMANO_FIJO = sizeof(uint64_t) + 1 + 2 * sizeof(int32_t) +
+                                      sizeof(int64_t) + sizeof(MarcaTiempo) + 2 * sizeof(uint32_t);
+
+    static void serializar(const EventoBanco& e, string& destino) {
+        uint32_t longitudes[2] = {static_cast<uint32_t>(e.nombre.size()),
+                                  static_cast<uint32_t>(e.dni.size())};
+        uint32_t longitud = static_cast<uint32_t>(TAMANO_FIJO) + longitudes[0] + longitudes[1];
+        uint8_t tipo = static_cast<uint8_t>(e.tipo);
+
+        char datos[TAMANO_FIJO];
+        char* p = datos;
+        memcpy(p, &e.secuencia, sizeof(e.secuencia)); p += sizeof(e.secuencia);
+        memcpy(p, &tipo, 1);                          p += 1;
+        memcpy(p, &e.cuenta, sizeof(e.cuenta));       p += sizeof(e.cuenta);
+        memcpy(p, &e.extra, sizeof(e.extra));         p += sizeof(e.extra);
+        memcpy(p, &e.centimos, sizeof(e.centimos));   p += sizeof(e.centimos);
+        memcpy(p, &e.marca, sizeof(e.marca));         p += sizeof(e.marca);
+        memcpy(p, longitudes, sizeof(longitudes));
+
+        size_t inicio = destino.size();
+        destino.append(reinterpret_cast<const char*>(&longitud), sizeof(longitud));
+        destino.append(4, '\0'); // Hueco para el CRC
+        destino.append(datos, TAMANO_FIJO);
+        destino.append(e.nombre);
+        destino.append(e.dni);
+        uint32_t crc = calcularCRC32(destino.data() + inicio + 8, longitud);
+        memcpy(&destino[inicio + 4], &crc, sizeof(crc));
+    }
+
+public:
+    RegistroBanco()
+        : archivo(nullptr), siguiente(1), durable(0), escribiendo(false), fallo(false),
+          ventanaMicros(0), eventos(0), grupos(0) {}
+
+    ~RegistroBanco() { cerrar(); }
+
+    RegistroBanco(const RegistroBanco&) = delete;
+    RegistroBanco& operator=(const RegistroBanco&) = delete;
+
+    // Empieza un WAL vacío; el primer evento recibirá primeraSecuencia
+    bool abrir(const string& ruta, uint64_t primeraSecuencia, unsigned ventana) {
+        cerrar();
+        lock_guard<mutex> guarda(cerrojo);
+        archivo = fopen(ruta.c_str(), "wb");
+        pendiente.clear();
+        siguiente = primeraSecuencia;
+        durable = primeraSecuencia - 1;
+        ventanaMicros = ventana;
+        fallo = false;
+        eventos = 0;
+        return archivo != nullptr;
+    }
+
+    // Escribe lo pendiente y cierra el archivo
+    void cerrar() {
+        if (!estaAbierto()) {
+            return;
+        }
+        esperarDurable(getUltimaSecuencia());
+        lock_guard<mutex> guarda(cerrojo);
+        fclose(archivo);
+        archivo = nullptr;
+    }
+
+    bool estaAbierto() {
+        lock_guard<mutex> guarda(cerrojo);
+        return archivo != nullptr;
+    }
+
+    // Añade el evento al búfer y devuelve su secuencia (sin esperar al disco)
+    uint64_t anotar(EventoBanco e) {
+        lock_guard<mutex> guarda(cerrojo);
+        e.secuencia = siguiente++;
+        serializar(e, pendiente);
+        eventos++;
+        return e.secuencia;
+    }
+
+    // Vuelve cuando el evento con esa secuencia (y todos los anteriores)
+    // está escrito y sincronizado; devuelve false si no ha podido llegar
+    // al disco (WAL sin abrir o escritura fallida)
+    bool esperarDurable(uint64_t secuencia) {
+        unique_lock<mutex> guarda(cerrojo);
+        while (durable < secuencia) {
+            if (!archivo || fallo) {
+                return false;
+            }
+            if (escribiendo) {
+                aviso.wait(guarda);
+                continue;
+            }
+            escribiendo = true;
+            if (ventanaMicros > 0) {
+                guarda.unlock();
+                this_thread::sleep_for(chrono::microseconds(ventanaMicros));
+                guarda.lock();
+            }
+            string lote;
+            lote.swap(pendiente);
+            uint64_t hasta = siguiente - 1;
+            guarda.unlock();
+
+            bool correcto = fwrite(lote.data(), 1, lote.size(), archivo) == lote.size();
+            correcto = sincronizarArchivo(archivo) && correcto;
+
+            guarda.lock();
+            if (correcto) {
+                durable = hasta;
+            } else {
+                fallo = true;
+            }
+            escribiendo = false;
+            grupos++;
+            aviso.notify_all();
+        }
+        return true;
+    }
+
+    // Última secuencia que ya está en disco
+    uint64_t getDurable() {
+        lock_guard<mutex> guarda(cerrojo);
+        return durable;
+    }
+
+    uint64_t getUltimaSecuencia() {
+        lock_guard<mutex> guarda(cerrojo);
+        return siguiente - 1;
+    }
+
+    void setVentana(unsigned ventana) {
+        lock_guard<mutex> guarda(cerrojo);
+        ventanaMicros = ventana;
+    }
+
+    unsigned getVentana() {
+        lock_guard<mutex> guarda(cerrojo);
+        return ventanaMicros;
+    }
+
+    uint64_t getEventos() {
+        lock_guard<mutex> guarda(cerrojo);
+        return eventos;
+    }
+
+    uint64_t getGrupos() {
+        lock_guard<mutex> guarda(cerrojo);
+        return grupos;
+    }
+
+    // Lee los eventos correctos del WAL; lo que haya tras el primer
+    // registro cortado o dañado (una caída a mitad de escritura) se ignora
+    static vector<EventoBanco> leer(const string& ruta) {
+        vector<EventoBanco> resultado;
+        ArchivoMapeado mapa(ruta);
+        LectorBinario lector(mapa.getDatos(), mapa.getLongitud());
+        uint32_t longitud;
+        uint32_t crc;
+        while (lector.leer(longitud) && lector.leer(crc) && longitud >= TAMANO_FIJO &&
+               lector.restantes() >= longitud &&
+               calcularCRC32(lector.posicion(), longitud) == crc) {
+            EventoBanco e;
+            uint8_t tipo = 0;
+            uint32_t longitudes[2] = {0, 0};
+            lector.leer(e.secuencia);
+            lector.leer(tipo);
+            lector.leer(e.cuenta);
+            lector.leer(e.extra);
+            lector.leer(e.centimos);
+            lector.leer(e.marca);
+            lector.leer(longitudes);
+            if (static_cast<uint64_t>(longitudes[0]) + longitudes[1] != longitud - TAMANO_FIJO) {
+                break;
+            }
+            lector.leerBytes(e.nombre, longitudes[0]);
+            lector.leerBytes(e.dni, longitudes[1]);
+            e.tipo = static_cast<TipoEventoBanco>(tipo);
+            resultado.push_back(e);
+        }
+        return resultado;
+    }
+};
+
+const size_t RegistroBanco::TAMANO_FIJO;
+
+// ===== CLASE ARENA =====
+// Reparte memoria de bloques grandes avanzando un puntero; nada se libera
+// por separado, todo desaparece con la arena. Varias cuentas comparten la
+// misma arena, por eso las reservas se protegen con un mutex.
+class Arena {
+private:
+    vector<unique_ptr<char[]>> bloques;
+    size_t tamanoBloque;
+    size_t usado;      // Bytes ocupados del último bloque
+    size_t reservados; // Bytes entregados en total
+    mutex cerrojo;
+
+public:
+    explicit Arena(size_t tamano = 64 * 1024)
+        : tamanoBloque(tamano), usado(tamano), reservados(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Devuelve bytes alineados a 8; si no caben en el bloque actual se
+    // abre uno nuevo
+    void* reservar(size_t bytes) {
+        lock_guard<mutex> guarda(cerrojo);
+        size_t inicio = (usado + 7) & ~static_cast<size_t>(7);
+        if (bloques.empty() || inicio + bytes > tamanoBloque) {
+            bloques.push_back(unique_ptr<char[]>(new char[max(bytes, tamanoBloque)]));
+            inicio = 0;
+        }
+        usado = inicio + bytes;
+        reservados += bytes;
+        return bloques.back().get() + inicio;
+    }
+
+    size_t getBytesReservados() {
+        lock_guard<mutex> guarda(cerrojo);
+        return reservados;
+    }
+};
+
+// ===== CLASE MAPARANURAS =====
+// Guarda objetos en ranuras dentro de bloques fijos (nunca se mueven) y
+// los identifica con un Manejador: posición de la ranura y generación.
+// Al eliminar un objeto su ranura cambia de generación y se reutiliza, así
+// un manejador antiguo deja de encontrar nada en vez de dar con el objeto
+// nuevo. Generación impar = ranura ocupada; 0 = manejador nulo.
+// Como en el resto del banco, insertar y eliminar no pueden coincidir con
+// búsquedas desde otros hilos.
+template <typename T>
+struct Manejador {
+    uint32_t indice;
+    uint32_t generacion;
+
+    Manejador() : indice(0), generacion(0) {}
+    Manejador(uint32_t i, uint32_t g) : indice(i), generacion(g) {}
+
+    bool esNulo() const { return generacion == 0; }
+    bool operator==(Manejador otro) const {
+        return indice == otro.indice && generacion == otro.generacion;
+    }
+    bool operator!=(Manejador otro) const { return !(*this == otro); }
+};
+
+template <typename T>
+class MapaRanuras {
+private:
+    struct Ranura {
+        typename aligned_storage<sizeof(T), alignof(T)>::type datos;
+        uint32_t generacion;
+        uint32_t siguienteLibre; // Lista de ranuras libres
+    };
+
+    static const uint32_t TAMANO_BLOQUE = 256;
+    static const uint32_t SIN_LIBRES = UINT32_MAX;
+
+    vector<unique_ptr<Ranura[]>> bloques;
+    uint32_t numRanuras;
+    uint32_t primeraLibre;
+    size_t vivos;
+
+    Ranura& ranura(uint32_t i) const { return bloques[i / TAMANO_BLOQUE][i % TAMANO_BLOQUE]; }
+    static T* objeto(Ranura& r) { return reinterpret_cast<T*>(&r.datos); }
+
+public:
+    MapaRanuras() : numRanuras(0), primeraLibre(SIN_LIBRES), vivos(0) {}
+
+    MapaRanuras(const MapaRanuras&) = delete;
+    MapaRanuras& operator=(const MapaRanuras&) = delete;
+
+    ~MapaRanuras() {
+        for (uint32_t i = 0; i < numRanuras; i++) {
+            if (ranura(i).generacion & 1) {
+                objeto(ranura(i))->~T();
+            }
+        }
+    }
+
+    // Construye el objeto en una ranura libre (o en una nueva)
+    template <typename... Argumentos>
+    Manejador<T> insertar(Argumentos&&... argumentos) {
+        uint32_t i;
+        if (primeraLibre != SIN_LIBRES) {
+            i = primeraLibre;
+            primeraLibre = ranura(i).siguienteLibre;
+        } else {
+            if (numRanuras % TAMANO_BLOQUE == 0) {
+                bloques.push_back(unique_ptr<Ranura[]>(new Ranura[TAMANO_BLOQUE]));
+                for (uint32_t k = 0; k < TAMANO_BLOQUE; k++) {
+                    bloques.back()[k].generacion = 0;
+                }
+            }
+            i = numRanuras++;
+        }
+        Ranura& r = ranura(i);
+        new (&r.datos) T(std::forward<Argumentos>(argumentos)...);
+        r.generacion++;
+        vivos++;
+        return Manejador<T>(i, r.generacion);
+    }
+
+    // Destruye el objeto; false si el manejador ya no era válido
+    bool eliminar(Manejador<T> m) {
+        T* t = obtener(m);
+        if (!t) {
+            return false;
+        }
+        t->~T();
+        Ranura& r = ranura(m.indice);
+        r.generacion++;
+        r.siguienteLibre = primeraLibre;
+        primeraLibre = m.indice;
+        vivos--;
+        return true;
+    }
+
+    // Objeto del manejador, o nullptr si se eliminó
+    T* obtener(Manejador<T> m) const {
+        if (m.indice >= numRanuras) {
+            return nullptr;
+        }
+        Ranura& r = ranura(m.indice);
+        return (r.generacion == m.generacion && (r.generacion & 1)) ? objeto(r) : nullptr;
+    }
+
+    // Objeto que ocupa la ranura i, o nullptr (para índices internos que se
+    // actualizan al eliminar)
+    T* enRanura(uint32_t i) const {
+        return (i < numRanuras && (ranura(i).generacion & 1)) ? objeto(ranura(i)) : nullptr;
+    }
+
+    // Recorre los objetos en orden de ranura; funcion(manejador, objeto)
+    template <typename Funcion>
+    void recorrer(Funcion funcion) const {
+        for (uint32_t i = 0; i < numRanuras; i++) {
+            Ranura& r = ranura(i);
+            if (r.generacion & 1) {
+                funcion(Manejador<T>(i, r.generacion), *objeto(r));
+            }
+        }
+    }
+
+    void reservar(size_t n) { bloques.reserve(n / TAMANO_BLOQUE + 1); }
+    uint32_t getNumRanuras() const { return numRanuras; }
+    size_t size() const { return vivos; }
+    bool empty() const { return vivos == 0; }
+};
+
+// ===== CLASE DIARIOTRANSACCIONES =====
+// Historial de una cuenta: solo se añade al final. Se guarda por tramos
+// y dentro de cada tramo por columnas (marcas, movimientos, ids y tipos
+// contiguos), con unos 21 bytes por transacción y sin objetos sueltos.
+// El movimiento lleva signo (+ abonos, - cargos), así el saldo es la suma
+// de la columna.
+// Los tramos salen de la arena y duplican su capacidad hasta un máximo,
+// así una cuenta con pocas operaciones ocupa poco.
+// Cada tramo guarda además el saldo antes de su primera transacción (un
+// punto de control) y su primera marca de tiempo: el saldo en una fecha
+// pasada se obtiene con una búsqueda binaria de tramo, otra dentro del
+// tramo y la suma de como mucho TRAMO_MAXIMO movimientos.
+class DiarioTransacciones {
+private:
+    struct Tramo {
+        MarcaTiempo* marcas;
+        int64_t* movimientos;
+        int32_t* ids;
+        uint8_t* tipos;
+        uint32_t capacidad;
+        uint32_t usados;
+        MarcaTiempo primera;   // Marca de la primera transacción del tramo
+        int64_t saldoAnterior; // Saldo antes de la primera transacción del tramo
+    };
+
+    static const uint32_t TRAMO_INICIAL = 8;
+    static const uint32_t TRAMO_MAXIMO = 4096;
+
+    Arena& arena;
+    vector<Tramo> tramos;
+    size_t total;
+    int64_t saldoFinal;       // Saldo tras la última transacción
+    MarcaTiempo ultimaMarca;
+
+    void nuevoTramo() {
+        uint32_t capacidad = tramos.empty()
+            ? TRAMO_INICIAL : min(tramos.back().capacidad * 2, TRAMO_MAXIMO);
+        // Columnas de mayor a menor alineación en una sola reserva
+        char* p = static_cast<char*>(arena.reservar(
+            capacidad * (sizeof(MarcaTiempo) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint8_t))));
+        Tramo t;
+        t.marcas = reinterpret_cast<MarcaTiempo*>(p); p += capacidad * sizeof(MarcaTiempo);
+        t.movimientos = reinterpret_cast<int64_t*>(p); p += capacidad * sizeof(int64_t);
+        t.ids = reinterpret_cast<int32_t*>(p);        p += capacidad * sizeof(int32_t);
+        t.tipos = reinterpret_cast<uint8_t*>(p);
+        t.capacidad = capacidad;
+        t.usados = 0;
+        t.primera = 0;
+        t.saldoAnterior = saldoFinal;
+        tramos.push_back(t);
+    }
+
+public:
+    explicit DiarioTransacciones(Arena& a)
+        : arena(a), total(0), saldoFinal(0), ultimaMarca(INT64_MIN) {}
+
+    // Añade una transacción al final del historial. Si el reloj del sistema
+    // retrocede, la marca se iguala a la anterior para que el historial
+    // siga ordenado por fecha.
+    void agregar(int id, TipoTransaccion tipo, Dinero monto, MarcaTiempo marca) {
+        if (tramos.empty() || tramos.back().usados == tramos.back().capacidad) {
+            nuevoTramo();
+        }
+        marca = max(marca, ultimaMarca);
+        int64_t movimiento = esAbono(tipo) ? monto.getCentimos() : -monto.getCentimos();
+        Tramo& t = tramos.back();
+        if (t.usados == 0) {
+            t.primera = marca;
+        }
+        t.marcas[t.usados] = marca;
+        t.movimientos[t.usados] = movimiento;
+        t.ids[t.usados] = id;
+        t.tipos[t.usados] = static_cast<uint8_t>(tipo);
+        t.usados++;
+        total++;
+        saldoFinal += movimiento; // Cabe: es el saldo de la cuenta
+        ultimaMarca = marca;
+    }
+
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+
+    // Recorre el historial en orden; funcion(id, tipo, monto, marca)
+    template <typename Funcion>
+    void recorrer(Funcion funcion) const {
+        for (const Tramo& t : tramos) {
+            for (uint32_t i = 0; i < t.usados; i++) {
+                int64_t c = t.movimientos[i];
+                funcion(static_cast<int>(t.ids[i]), static_cast<TipoTransaccion>(t.tipos[i]),
+                        Dinero(c < 0 ? -c : c), t.marcas[i]);
+            }
+        }
+    }
+
+    // Saldo que resulta de todo el historial (suma vectorizada por tramos)
+    Dinero sumarMovimientos() const {
+        uint64_t total = 0;
+        for (const Tramo& t : tramos) {
+            total += sumarCentimos(t.movimientos, t.usados);
+        }
+        return Dinero(static_cast<int64_t>(total));
+    }
+
+    // Escribe el historial como tres columnas (marcas, movimientos y tipos)
+    // con el formato de escribirVector; el id de cada transacción es su
+    // posición y no se guarda
+    void guardar(FILE* archivo) const {
+        escribirValor<uint64_t>(archivo, total);
+        for (const Tramo& t : tramos) {
+            fwrite(t.marcas, sizeof(MarcaTiempo), t.usados, archivo);
+        }
+        escribirValor<uint64_t>(archivo, total);
+        for (const Tramo& t : tramos) {
+            fwrite(t.movimientos, sizeof(int64_t), t.usados, archivo);
+        }
+        escribirValor<uint64_t>(archivo, total);
+        for (const Tramo& t : tramos) {
+            fwrite(t.tipos, sizeof(uint8_t), t.usados, archivo);
+        }
+    }
+
+    // Saldo tras todas las transacciones con marca <= instante
+    Dinero saldoEn(MarcaTiempo instante) const {
+        // Último tramo que empieza en o antes del instante
+        auto tramo = upper_bound(tramos.begin(), tramos.end(), instante,
+            [](MarcaTiempo m, const Tramo& t) { return m < t.primera; });
+        if (tramo == tramos.begin()) {
+            return Dinero();
+        }
+        --tramo;
+        size_t hasta = static_cast<size_t>(
+            upper_bound(tramo->marcas, tramo->marcas + tramo->usados, instante) - tramo->marcas);
+        return Dinero(static_cast<int64_t>(static_cast<uint64_t>(tramo->saldoAnterior) +
+                                           sumarCentimos(tramo->movimientos, hasta)));
+    }
+
+    // Variación neta del saldo entre desde y hasta (ambos incluidos)
+    Dinero flujoEntre(MarcaTiempo desde, MarcaTiempo hasta) const {
+        Dinero flujo = saldoEn(hasta);
+        flujo.restar(saldoEn(desde - 1)); // Diferencia de dos saldos: cabe
+        return flujo;
+    }
+};
+
+const uint32_t DiarioTransacciones::TRAMO_INICIAL;
+const uint32_t DiarioTransacciones::TRAMO_MAXIMO;
+
+// ===== CLASE DETECTORVELOCIDAD =====
+// Vigila los retiros (retiros y transferencias enviadas) de cada cuenta en
+// una ventana deslizante: avisa si en la ventana hay más de maxRetiros o
+// si suman más de maxImporte. Cada cuenta guarda sus últimos maxRetiros+1
+// retiros en un búfer circular de tamaño fijo, con la suma de los que
+// siguen dentro de la ventana; cada retiro saca los que han caducado y
+// comprueba las reglas sin volver a mirar el historial, con un coste
+// acotado por el tamaño del búfer.
+// Si el búfer está lleno y su retiro más antiguo sigue en la ventana, ya
+// hay más de maxRetiros: salta la regla de número y ese retiro se descarta
+// (la suma puede quedarse corta mientras tanto, pero la cuenta ya está
+// avisada).
+// Los datos de una cuenta se tocan con el cerrojo de esa cuenta tomado;
+// admitir() debe llamarse antes de operar, como las altas del banco. Cada
+// banco tiene su detector y numera sus cuentas desde 1, así que el número
+// es la posición de la cuenta y los búferes crecen con las cuentas del
+// banco, no con las de todo el programa.
+struct AlertaVelocidad {
+    int numeroCuenta;
+    MarcaTiempo marca;
+    int retiros;       // Retiros en la ventana al saltar la alerta (como mucho maxRetiros+1)
+    Dinero importe;    // Suma de esos retiros
+};
+
+class DetectorVelocidad {
+private:
+    struct Estado {
+        uint32_t inicio;   // Posición del retiro más antiguo en el búfer
+        uint32_t usados;
+        int64_t suma;      // Céntimos de los retiros del búfer
+        bool avisada;      // Ya hay una alerta abierta
+    };
+
+    int maxRetiros;
+    int64_t maxCentimos;
+    MarcaTiempo ventana;  // Segundos
+    uint32_t capacidad;   // Retiros guardados por cuenta: maxRetiros + 1
+    // Búferes de todas las cuentas seguidos: el de la cuenta n empieza en
+    // n * capacidad
+    vector<MarcaTiempo> marcas;
+    vector<int64_t> importes;
+    vector<Estado> estados;
+
+    mutex cerrojoAlertas;
+    vector<AlertaVelocidad> alertas;
+
+public:
+    DetectorVelocidad(int maxR, Dinero maxImporte, MarcaTiempo segundos = 600)
+        : maxRetiros(max(maxR, 0)), maxCentimos(maxImporte.getCentimos()), ventana(segundos),
+          capacidad(static_cast<uint32_t>(max(maxR, 0)) + 1) {}
+
+    DetectorVelocidad(const DetectorVelocidad&) = delete;
+    DetectorVelocidad& operator=(const DetectorVelocidad&) = delete;
+
+    // Prepara el sitio de las cuentas del banco hasta ese número
+    void admitir(int numero) {
+        size_t n = static_cast<size_t>(numero) + 1;
+        if (n > estados.size()) {
+            n = max(n, estados.size() * 2);
+            estados.resize(n, Estado{0, 0, 0, false});
+            marcas.resize(n * capacidad);
+            importes.resize(n * capacidad);
+        }
+    }
+
+    // Anota un retiro; devuelve true si abre una alerta para la cuenta
+    bool observar(int numero, Dinero monto, MarcaTiempo marca) {
+        Estado& e = estados[static_cast<size_t>(numero)];
+        MarcaTiempo* m = &marcas[static_cast<size_t>(numero) * capacidad];
+        int64_t* importe = &importes[static_cast<size_t>(numero) * capacidad];
+
+        // Fuera los retiros que ya han salido de la ventana
+        while (e.usados > 0 && m[e.inicio] <= marca - ventana) {
+            e.suma -= importe[e.inicio];
+            e.inicio = (e.inicio + 1 == capacidad) ? 0 : e.inicio + 1;
+            e.usados--;
+        }
+        if (e.usados == capacidad) { // Ya había más de maxRetiros en la ventana
+            e.suma -= importe[e.inicio];
+            e.inicio = (e.inicio + 1 == capacidad) ? 0 : e.inicio + 1;
+            e.usados--;
+        }
+        uint32_t fin = e.inicio + e.usados;
+        fin = (fin >= capacidad) ? fin - capacidad : fin;
+        m[fin] = marca;
+        importe[fin] = monto.getCentimos();
+        e.usados++;
+        e.suma += monto.getCentimos();
+
+        bool excede = e.usados > static_cast<uint32_t>(maxRetiros) || e.suma > maxCentimos;
+        bool nueva = excede && !e.avisada;
+        e.avisada = excede;
+        if (nueva) {
+            lock_guard<mutex> guarda(cerrojoAlertas);
+            alertas.push_back(AlertaVelocidad{numero, marca, static_cast<int>(e.usados),
+                                              Dinero(e.suma)});
+        }
+        return nueva;
+    }
+
+    vector<AlertaVelocidad> getAlertas() {
+        lock_guard<mutex> guarda(cerrojoAlertas);
+        return alertas;
+    }
+
+    size_t getNumAlertas() {
+        lock_guard<mutex> guarda(cerrojoAlertas);
+        return alertas.size();
+    }
+
+    MarcaTiempo getVentana() const { return ventana; }
+};
+
+// ===== CLASE CUENTA =====
+// Cada cuenta tiene su propio mutex: varios cajeros pueden operar a la vez
+// sobre cuentas distintas y solo esperan si coinciden en la misma.
+class Cuenta {
+private:
+    int numero;
+    TipoCuenta tipo;
+    Dinero saldo;
+    string titular;
+    DiarioTransacciones transacciones;
+    mutable mutex cerrojo;
+    RegistroBanco* registro; // WAL del banco, o nullptr sin persistencia
+    DetectorVelocidad* detector; // Vigilancia de retiros, o nullptr
+
+    // Anota una transacción en el historial (con el cerrojo tomado)
+    void anotar(TipoTransaccion tipoTrans, Dinero monto, MarcaTiempo marca) {
+        transacciones.agregar(static_cast<int>(transacciones.size() + 1), tipoTrans,
+                              monto, marca);
+    }
+
+    // Anota el movimiento en el WAL con el cerrojo de la cuenta tomado, así
+    // el orden del WAL es el mismo que el del historial; devuelve la
+    // secuencia del evento o 0 sin persistencia
+    uint64_t registrar(TipoEventoBanco evento, int destino, Dinero monto, MarcaTiempo marca) {
+        if (!registro) {
+            return 0;
+        }
+        return registro->anotar(EventoBanco{evento, 0, numero, destino, monto.getCentimos(),
+                                            marca, "", ""});
+    }
+
+    // Sin secuencia donde dejarla, se espera a que el evento esté en disco
+    // (ya sin el cerrojo de la cuenta); con ella, esperar es cosa de quien llama
+    ResultadoOperacion confirmar(uint64_t evento, uint64_t* secuencia) {
+        if (secuencia) {
+            *secuencia = evento;
+        } else if (evento && !registro->esperarDurable(evento)) {
+            return ERROR_PERSISTENCIA;
+        }
+        return OPERACION_OK;
+    }
+
+public:
+    // El número lo da el banco (cada banco numera sus cuentas desde 1); el
+    // historial se guarda en la arena indicada (normalmente la del banco)
+    Cuenta(int n, TipoCuenta t, string tit, Arena& arena)
+        : numero(n), tipo(t), saldo(), titular(tit), transacciones(arena), registro(nullptr),
+          detector(nullptr) {}
+
+    void setRegistro(RegistroBanco* r) {
+        lock_guard<mutex> guarda(cerrojo);
+        registro = r;
+    }
+
+    void setDetector(DetectorVelocidad* d) {
+        lock_guard<mutex> guarda(cerrojo);
+        detector = d;
+    }
+
+    int getNumero() const { return numero; }
+    TipoCuenta getTipo() const { return tipo; }
+    string getTitular() const { return titular; }
+
+    Dinero getSaldo() const {
+        lock_guard<mutex> guarda(cerrojo);
+        return saldo;
+    }
+
+    size_t getNumTransacciones() const {
+        lock_guard<mutex> guarda(cerrojo);
+        return transacciones.size();
+    }
+
+    // Depósito sin mensajes, seguro entre hilos. Con persistencia, vuelve
+    // cuando el depósito ya está en el WAL en disco, salvo que se pase
+    // secuencia: entonces se deja ahí el evento para esperarlo después.
+    ResultadoOperacion intentarDeposito(Dinero monto, uint64_t* secuencia = nullptr) {
+        if (monto <= Dinero()) {
+            return MONTO_INVALIDO;
+        }
+        uint64_t evento;
+        {
+            lock_guard<mutex> guarda(cerrojo);
+            if (!saldo.sumar(monto)) {
+                return DESBORDAMIENTO;
+            }
+            MarcaTiempo marca = marcaActual();
+            anotar(DEPOSITO, monto, marca);
+            evento = registrar(EVENTO_DEPOSITO, 0, monto, marca);
+        }
+        return confirmar(evento, secuencia);
+    }
+
+    // Retiro sin mensajes, seguro entre hilos (igual que el depósito)
+    ResultadoOperacion intentarRetiro(Dinero monto, uint64_t* secuencia = nullptr) {
+        if (monto <= Dinero()) {
+            return MONTO_INVALIDO;
+        }
+        uint64_t evento;
+        {
+            lock_guard<mutex> guarda(cerrojo);
+            if (saldo < monto) {
+                return SALDO_INSUFICIENTE;
+            }
+            saldo.restar(monto); // No desborda: 0 < monto <= saldo
+            MarcaTiempo marca = marcaActual();
+            anotar(RETIRO, monto, marca);
+            if (detector) {
+                detector->observar(numero, monto, marca);
+            }
+            evento = registrar(EVENTO_RETIRO, 0, monto, marca);
+        }
+        return confirmar(evento, secuencia);
+    }
+
+    // Abono de intereses sin mensajes (liquidación mensual)
+    ResultadoOperacion abonarIntereses(Dinero monto, uint64_t* secuencia = nullptr) {
+        if (monto <= Dinero()) {
+            return MONTO_INVALIDO;
+        }
+        uint64_t evento;
+        {
+            lock_guard<mutex> guarda(cerrojo);
+            if (!saldo.sumar(monto)) {
+                return DESBORDAMIENTO;
+            }
+            MarcaTiempo marca = marcaActual();
+            anotar(INTERES, monto, marca);
+            evento = registrar(EVENTO_INTERES, 0, monto, marca);
+        }
+        return confirmar(evento, secuencia);
+    }
+
+    // Cobro de la comisión de mantenimiento sin mensajes. Si el saldo no
+    // llega se cobra lo que haya: la cuenta nunca queda en negativo. En
+    // cobrado se deja lo que se ha cobrado de verdad.
+    ResultadoOperacion cobrarComision(Dinero monto, Dinero& cobrado,
+                                      uint64_t* secuencia = nullptr) {
+        cobrado = Dinero();
+        if (monto <= Dinero()) {
+            return MONTO_INVALIDO;
+        }
+        uint64_t evento;
+        {
+            lock_guard<mutex> guarda(cerrojo);
+            if (saldo <= Dinero()) {
+                return SALDO_INSUFICIENTE;
+            }
+            cobrado = min(monto, saldo);
+            saldo.restar(cobrado);
+            MarcaTiempo marca = marcaActual();
+            anotar(COMISION, cobrado, marca);
+            evento = registrar(EVENTO_COMISION, 0, cobrado, marca);
+        }
+        return confirmar(evento, secuencia);
+    }
+
+    // Aplica un movimiento ya validado con su marca original, sin WAL (al
+    // recuperar desde el snapshot o el WAL)
+    void repetir(TipoTransaccion tipoTrans, Dinero monto, MarcaTiempo marca) {
+        lock_guard<mutex> guarda(cerrojo);
+        if (esAbono(tipoTrans)) {
+            saldo.sumar(monto);
+        } else {
+            saldo.restar(monto);
+        }
+        anotar(tipoTrans, monto, marca);
+    }
+
+    // Escribe el historial en un snapshot
+    void guardarHistorial(FILE* archivo) const {
+        lock_guard<mutex> guarda(cerrojo);
+        transacciones.guardar(archivo);
+    }
+
+    // Mueve dinero entre dos cuentas de forma atómica: nadie puede ver el
+    // dinero fuera de ambas. Los cerrojos se toman siempre en orden de
+    // número de cuenta, así dos transferencias cruzadas (A->B y B->A) no
+    // pueden bloquearse mutuamente.
+    static ResultadoOperacion transferir(Cuenta& origen, Cuenta& destino, Dinero monto,
+                                         uint64_t* secuencia = nullptr) {
+        if (&origen == &destino) {
+            return MISMA_CUENTA;
+        }
+        if (monto <= Dinero()) {
+            return MONTO_INVALIDO;
+        }
+        Cuenta& primera = (origen.numero < destino.numero) ? origen : destino;
+        Cuenta& segunda = (origen.numero < destino.numero) ? destino : origen;
+        uint64_t evento;
+        {
+            lock_guard<mutex> guardaPrimera(primera.cerrojo);
+            lock_guard<mutex> guardaSegunda(segunda.cerrojo);
+            if (origen.saldo < monto) {
+                return SALDO_INSUFICIENTE;
+            }
+            if (!destino.saldo.sumar(monto)) {
+                return DESBORDAMIENTO;
+            }
+            origen.saldo.restar(monto);
+            MarcaTiempo marca = marcaActual();
+            origen.anotar(TRANSFERENCIA_ENVIADA, monto, marca);
+            if (origen.detector) {
+                origen.detector->observar(origen.numero, monto, marca);
+            }
+            destino.anotar(TRANSFERENCIA_RECIBIDA, monto, marca);
+            evento = origen.registrar(EVENTO_TRANSFERENCIA, destino.numero, monto, marca);
+        }
+        return origen.confirmar(evento, secuencia);
+    }
+
+    // Método para realizar depósito
+    bool depositar(Dinero monto) {
+        switch (intentarDeposito(monto)) {
+        case MONTO_INVALIDO:
+            cout << "Error: El monto debe ser mayor a 0" << endl;
+            return false;
+        case DESBORDAMIENTO:
+            cout << "Error: El saldo superaría el máximo permitido" << endl;
+            return false;
+        case ERROR_PERSISTENCIA:
+            cout << "Error: La operación no se pudo guardar en disco" << endl;
+            return false;
+        default:
+            break;
+        }
+        cout << "Depósito realizado: $" << monto << endl;
+        return true;
+    }
+
+    // Método para realizar retiro
+    bool retirar(Dinero monto) {
+        switch (intentarRetiro(monto)) {
+        case MONTO_INVALIDO:
+            cout << "Error: El monto debe ser mayor a 0" << endl;
+            return false;
+        case SALDO_INSUFICIENTE:
+            cout << "Error: Saldo insuficiente" << endl;
+            return false;
+        case ERROR_PERSISTENCIA:
+            cout << "Error: La operación no se pudo guardar en disco" << endl;
+            return false;
+        default:
+            break;
+        }
+        cout << "Retiro realizado: $" << monto << endl;
+        return true;
+    }
+
+    // Saldo que tenía la cuenta en un instante pasado
+    Dinero saldoEn(MarcaTiempo instante) const {
+        lock_guard<mutex> guarda(cerrojo);
+        return transacciones.saldoEn(instante);
+    }
+
+    // Variación neta del saldo entre dos instantes (ambos incluidos)
+    Dinero flujoEntre(MarcaTiempo desde, MarcaTiempo hasta) const {
+        lock_guard<mutex> guarda(cerrojo);
+        return transacciones.flujoEntre(desde, hasta);
+    }
+
+    // Comprueba que el saldo guardado coincide con la suma del historial;
+    // calculado recibe esa suma
+    bool conciliar(Dinero& calculado) const {
+        lock_guard<mutex> guarda(cerrojo);
+        calculado = transacciones.sumarMovimientos();
+        return calculado == saldo;
+    }
+
+    // Método para mostrar información
+    void mostrarInfo() const {
+        string tipoStr = (tipo == AHORROS) ? "AHORROS" : "CORRIENTE";
+        cout << "Cuenta #" << numero << " - " << tipoStr << endl;
+        cout << "Titular: " << titular << endl;
+        cout << "Saldo: $" << getSaldo() << endl;
+    }
+
+    // Método para mostrar historial
+    void mostrarHistorial() const {
+        lock_guard<mutex> guarda(cerrojo);
+        cout << "\n=== HISTORIAL DE TRANSACCIONES - Cuenta #" << numero << " ===" << endl;
+        if (transacciones.empty()) {
+            cout << "No hay transacciones registradas" << endl;
+        } else {
+            transacciones.recorrer([this](int id, TipoTransaccion t, Dinero monto, MarcaTiempo marca) {
+                Transaccion(id, t, monto, marca, numero).mostrarInfo();
+            });
+        }
+    }
+};
+
+// ===== CLASE CLIENTE =====
+class Cliente {
+private:
+    string nombre;
+    string dni;
+    vector<Manejador<Cuenta>> cuentas; // Las cuentas las guarda el banco
+
+public:
+    Cliente(string n, string d) : nombre(n), dni(d) {}
+
+    const string& getNombre() const { return nombre; }
+    const string& getDni() const { return dni; }
+    const vector<Manejador<Cuenta>>& getCuentas() const { return cuentas; }
+
+    // Método para agregar cuenta
+    void agregarCuenta(Manejador<Cuenta> cuenta) {
+        vincularCuenta(cuenta);
+        cout << "Cuenta agregada al cliente " << nombre << endl;
+    }
+
+    // Agrega la cuenta sin mensajes (al recuperar el banco desde disco)
+    void vincularCuenta(Manejador<Cuenta> cuenta) {
+        cuentas.push_back(cuenta);
+    }
+
+    // Quita una cuenta cerrada
+    void quitarCuenta(Manejador<Cuenta> cuenta) {
+        cuentas.erase(remove(cuentas.begin(), cuentas.end(), cuenta), cuentas.end());
+    }
+
+    // Método para mostrar información (las cuentas se buscan en el banco)
+    void mostrarInfo(const MapaRanuras<Cuenta>& todas) const {
+        cout << "Cliente: " << nombre << " (DNI: " << dni << ")" << endl;
+        cout << "Cuentas: " << cuentas.size() << endl;
+        for (Manejador<Cuenta> m : cuentas) {
+            todas.obtener(m)->mostrarInfo();
+            cout << "---" << endl;
+        }
+    }
+};
+
+// ===== CLASE LECTOROPERACIONES =====
+// Analiza en paralelo un archivo de operaciones ya cargado en memoria, con
+// una operación por línea: cuenta,tipo,importe (tipo D/DEPOSITO o
+// R/RETIRO). Una primera línea que no empiece por un dígito es la
+// cabecera. Las líneas mal formadas se devuelven marcadas como no válidas
+// para poder informar de ellas.
+struct OperacionLote {
+    int cuenta;
+    TipoTransaccion tipo;
+    Dinero monto;
+    bool valida;
+};
+
+class LectorOperaciones {
+private:
+    const char* datos;
+    size_t longitud;
+
+    static bool leerCuenta(const char* p, const char* fin, int& cuenta) {
+        if (p == fin) {
+            return false;
+        }
+        int64_t valor = 0;
+        for (; p < fin; p++) {
+            if (*p < '0' || *p > '9' || valor > INT32_MAX / 10) {
+                return false;
+            }
+            valor = valor * 10 + (*p - '0');
+        }
+        if (valor > INT32_MAX) {
+            return false;
+        }
+        cuenta = static_cast<int>(valor);
+        return true;
+    }
+
+    static bool leerTipo(const char* p, const char* fin, TipoTransaccion& tipo) {
+        string texto(p, fin);
+        if (texto == "D" || texto == "DEPOSITO") {
+            tipo = DEPOSITO;
+        } else if (texto == "R" || texto == "RETIRO") {
+            tipo = RETIRO;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Analiza una línea sin el salto final
+    static OperacionLote analizarLinea(const char* p, const char* fin) {
+        OperacionLote op = {0, DEPOSITO, Dinero(), false};
+        const char* coma1 = static_cast<const char*>(memchr(p, ',', fin - p));
+        const char* coma2 = coma1 ? static_cast<const char*>(memchr(coma1 + 1, ',', fin - coma1 - 1)) : nullptr;
+        if (!coma2) {
+            return op;
+        }
+        op.valida = leerCuenta(p, coma1, op.cuenta) &&
+                    leerTipo(coma1 + 1, coma2, op.tipo) &&
+                    Dinero::leer(coma2 + 1, static_cast<size_t>(fin - coma2 - 1), op.monto);
+        return op;
+    }
+
+    // Analiza las líneas entre inicio y fin (que acaba en salto de línea o
+    // en el final del archivo)
+    static void analizarTrozo(const char* inicio, const char* fin, bool primero,
+                              vector<OperacionLote>& salida) {
+        const char* p = inicio;
+        if (primero && p < fin && (*p < '0' || *p > '9')) {
+            const char* salto = static_cast<const char*>(memchr(p, '\n', fin - p));
+            p = salto ? salto + 1 : fin;
+        }
+        while (p < fin) {
+            const char* salto = static_cast<const char*>(memchr(p, '\n', fin - p));
+            const char* finLinea = salto ? salto : fin;
+            const char* finDatos = finLinea;
+            if (finDatos > p && finDatos[-1] == '\r') {
+                finDatos--;
+            }
+            if (finDatos > p) { // Las líneas vacías no cuentan
+                salida.push_back(analizarLinea(p, finDatos));
+            }
+            p = salto ? salto + 1 : fin;
+        }
+    }
+
+public:
+    LectorOperaciones(const char* d, size_t l) : datos(d), longitud(l) {}
+
+    // Devuelve todas las operaciones en el orden del archivo
+    vector<OperacionLote> analizar() const {
+        const size_t minimoPorHilo = 1 << 20; // No merece la pena trocear menos de 1 MiB
+        size_t hilos = max(1u, thread::hardware_concurrency());
+        hilos = min(hilos, longitud / minimoPorHilo + 1);
+
+        // Cortes en saltos de línea para no partir operaciones
+        vector<const char*> cortes(1, datos);
+        for (size_t h = 1; h < hilos; h++) {
+            const char* corte = max(cortes.back(), datos + longitud * h / hilos);
+            const char* salto = static_cast<const char*>(
+                memchr(corte, '\n', datos + longitud - corte));
+            cortes.push_back(salto ? salto + 1 : datos + longitud);
+        }
+        cortes.push_back(datos + longitud);
+
+        vector<vector<OperacionLote>> partes(hilos);
+        vector<thread> trabajadores;
+        for (size_t h = 0; h < hilos; h++) {
+            trabajadores.emplace_back([&, h]() {
+                partes[h].reserve(static_cast<size_t>(cortes[h + 1] - cortes[h]) / 16);
+                analizarTrozo(cortes[h], cortes[h + 1], h == 0, partes[h]);
+            });
+        }
+        for (auto& t : trabajadores) {
+            t.join();
+        }
+
+        size_t total = 0;
+        for (const auto& parte : partes) {
+            total += parte.size();
+        }
+        vector<OperacionLote> operaciones;
+        operaciones.reserve(total);
+        for (const auto& parte : partes) {
+            operaciones.insert(operaciones.end(), parte.begin(), parte.end());
+        }
+        return operaciones;
+    }
+};
+
+// Resumen de un lote procesado
+struct ResumenLote {
+    bool archivoAbierto;
+    bool resultadosGuardados;
+    size_t operaciones;
+    size_t aplicadas;
+    size_t rechazadas;
+};
+
+// ===== CLASE INDICEDNI =====
+// Tabla hash de direccionamiento abierto (sondeo lineal) de DNI a la
+// posición del cliente. Cada ranura guarda el hash completo, así al crecer
+// no hay que volver a leer los DNI y casi todas las comparaciones de texto
+// se evitan; la comparación final la hace quien busca.
+class IndiceDNI {
+private:
+    vector<uint64_t> hashes;    // 0 = ranura libre
+    vector<int32_t> posiciones;
+    size_t ocupadas;
+
+    static uint64_t calcularHash(const string& dni) {
+        uint64_t h = 1469598103934665603ULL; // FNV-1a
+        for (unsigned char c : dni) {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h ? h : 1;
+    }
+
+    void crecer() {
+        vector<uint64_t> viejosHashes;
+        vector<int32_t> viejasPosiciones;
+        viejosHashes.swap(hashes);
+        viejasPosiciones.swap(posiciones);
+        size_t capacidad = max<size_t>(16, viejosHashes.size() * 2);
+        hashes.assign(capacidad, 0);
+        posiciones.assign(capacidad, -1);
+        for (size_t i = 0; i < viejosHashes.size(); i++) {
+            if (viejosHashes[i]) {
+                colocar(viejosHashes[i], viejasPosiciones[i]);
+            }
+        }
+    }
+
+    void colocar(uint64_t h, int32_t posicion) {
+        size_t mascara = hashes.size() - 1;
+        size_t i = static_cast<size_t>(h) & mascara;
+        while (hashes[i]) {
+            i = (i + 1) & mascara;
+        }
+        hashes[i] = h;
+        posiciones[i] = posicion;
+    }
+
+public:
+    IndiceDNI() : ocupadas(0) {}
+
+    // Posición del cliente con ese DNI o -1; igual(posicion) comprueba si
+    // el cliente de esa posición tiene realmente el DNI buscado
+    template <typename Igual>
+    int buscar(const string& dni, Igual igual) const {
+        if (hashes.empty()) {
+            return -1;
+        }
+        uint64_t h = calcularHash(dni);
+        size_t mascara = hashes.size() - 1;
+        for (size_t i = static_cast<size_t>(h) & mascara; hashes[i]; i = (i + 1) & mascara) {
+            if (hashes[i] == h && igual(posiciones[i])) {
+                return posiciones[i];
+            }
+        }
+        return -1;
+    }
+
+    // Añade un DNI que no estaba en el índice
+    void insertar(const string& dni, int posicion) {
+        if ((ocupadas + 1) * 4 > hashes.size() * 3) { // Carga máxima del 75%
+            crecer();
+        }
+        colocar(calcularHash(dni), static_cast<int32_t>(posicion));
+        ocupadas++;
+    }
+
+    // Prepara el índice para n clientes sin crecer por el camino
+    void reservar(size_t n) {
+        while (n * 4 > hashes.size() * 3) {
+            crecer();
+        }
+    }
+};
+
+// ===== CLASE BANCO =====
+// Cuenta cuyo saldo no coincide con la suma de su historial
+struct Descuadre {
+    int numeroCuenta;
+    Dinero saldo;
+    Dinero calculado;
+};
+
+// Resultado de una liquidación mensual
+struct ResumenLiquidacion {
+    size_t cuentas;     // Cuentas revisadas
+    size_t abonos;      // Cuentas de ahorros con intereses abonados
+    size_t cargos;      // Cuentas corrientes con comisión cobrada
+    Dinero intereses;
+    Dinero comisiones;
+    double segundos;
+    bool guardada;      // Con persistencia, todo llegó al WAL en disco
+};
+
+// Depósitos, retiros y transferencias pueden hacerse desde varios hilos a
+// la vez (un hilo por cajero): cada operación bloquea solo sus cuentas.
+// Los registros de clientes y las altas de cuentas deben terminar antes de
+// empezar a operar.
+// Con persistencia activada (activarPersistencia) cada operación vuelve
+// cuando ya está en el WAL en disco, y el estado completo se guarda en un
+// snapshot al activar y con compactar(), que vacía el WAL.
+class Banco {
+private:
+    RegistroBanco registro; // Se destruye el último: las cuentas lo apuntan
+    unique_ptr<DetectorVelocidad> detector; // Vigilancia de retiros, si se activa
+    string rutaSnapshot;
+    string rutaRegistro;
+    string nombre;
+    Arena arena; // Memoria de los historiales; se destruye tras las cuentas
+    // Clientes y cuentas viven en mapas de ranuras y se enlazan con
+    // manejadores, sin contadores de referencias
+    MapaRanuras<Cliente> clientes;
+    MapaRanuras<Cuenta> cuentas;
+
+    // Cada banco numera sus cuentas desde 1, sin huecos: el número es
+    // directamente la posición en este vector, que crece con las cuentas de
+    // este banco y no con las de los demás. Una entrada nula o de una cuenta
+    // ya cerrada no lleva a ninguna cuenta.
+    struct EntradaCuenta {
+        Manejador<Cuenta> cuenta;
+        uint32_t cliente; // Ranura del titular
+    };
+    vector<EntradaCuenta> indiceCuentas;
+    int ultimoNumero; // Último número de cuenta dado (incluidas las ya cerradas)
+    IndiceDNI indiceClientes; // DNI -> ranura del cliente (no se borran)
+
+    // Método auxiliar para buscar cuenta; el puntero vale hasta que se
+    // cierre la cuenta
+    Cuenta* buscarCuenta(int numero) const {
+        if (numero < 0 || static_cast<size_t>(numero) >= indiceCuentas.size()) {
+            return nullptr;
+        }
+        return cuentas.obtener(indiceCuentas[numero].cuenta);
+    }
 
-public:
-    Cuenta(TipoCuenta t, string tit) 
-        : tipo(t), saldo(0.0), titular(tit) {
-        numero = ++contadorCuentas;
+    // Ranura del cliente con ese DNI, o -1
+    int ranuraCliente(const string& dni) const {
+        return indiceClientes.buscar(dni, [this, &dni](int p) {
+            return clientes.enRanura(static_cast<uint32_t>(p))->getDni() == dni;
+        });
     }
 
-    int getNumero() const { return numero; }
-    TipoCuenta getTipo() const { return tipo; }
-    double getSaldo() const { return saldo; }
-    string getTitular() const { return titular; }
+    // Método auxiliar para buscar cliente
+    Cliente* buscarCliente(const string& dni) const {
+        int pos = ranuraCliente(dni);
+        return (pos < 0) ? nullptr : clientes.enRanura(static_cast<uint32_t>(pos));
+    }
 
-    // Método para realizar depósito
-    bool depositar(double monto) {
-        if (monto <= 0) {
-            cout << "Error: El monto debe ser mayor a 0" << endl;
-            return false;
-        }
-        saldo += monto;
-        transacciones.push_back(make_shared<Transaccion>(
-            transacciones.size() + 1, DEPOSITO, monto, numero));
-        cout << "Depósito realizado: $" << monto << endl;
-        return true;
+    // Alta de cliente sin mensajes ni comprobaciones
+    Cliente* altaCliente(const string& nombreCliente, const string& dni) {
+        Manejador<Cliente> m = clientes.insertar(nombreCliente, dni);
+        indiceClientes.insertar(dni, static_cast<int>(m.indice));
+        return clientes.obtener(m);
     }
 
-    // Método para realizar retiro
-    bool retirar(double monto) {
-        if (monto <= 0) {
-            cout << "Error: El monto debe ser mayor a 0" << endl;
-            return false;
+    // Añade al índice una cuenta recién insertada (sin asociarla al cliente)
+    Cuenta* altaCuenta(Manejador<Cuenta> m, int titular) {
+        Cuenta* cuenta = cuentas.obtener(m);
+        ultimoNumero = max(ultimoNumero, cuenta->getNumero());
+        size_t numero = static_cast<size_t>(cuenta->getNumero());
+        if (numero >= indiceCuentas.size()) {
+            indiceCuentas.resize(max(numero + 1, indiceCuentas.size() * 2), EntradaCuenta());
         }
-        if (saldo < monto) {
-            cout << "Error: Saldo insuficiente" << endl;
-            return false;
+        indiceCuentas[numero] = EntradaCuenta{m, static_cast<uint32_t>(titular)};
+        if (registro.estaAbierto()) {
+            cuenta->setRegistro(&registro);
         }
-        saldo -= monto;
-        transacciones.push_back(make_shared<Transaccion>(
-            transacciones.size() + 1, RETIRO, monto, numero));
-        cout << "Retiro realizado: $" << monto << endl;
-        return true;
+        if (detector) {
+            detector->admitir(cuenta->getNumero());
+            cuenta->setDetector(detector.get());
+        }
+        return cuenta;
     }
 
-    // Método para mostrar información
-    void mostrarInfo() const {
-        string tipoStr = (tipo == AHORROS) ? "AHORROS" : "CORRIENTE";
-        cout << "Cuenta #" << numero << " - " << tipoStr << endl;
-        cout << "Titular: " << titular << endl;
-        cout << "Saldo: $" << fixed << setprecision(2) << saldo << endl;
+    // Cierra la cuenta sin mensajes: deja de estar en el índice y en su
+    // cliente, y su ranura queda libre para otra
+    void bajaCuenta(int numero) {
+        EntradaCuenta& entrada = indiceCuentas[numero];
+        clientes.enRanura(entrada.cliente)->quitarCuenta(entrada.cuenta);
+        cuentas.eliminar(entrada.cuenta);
+        entrada = EntradaCuenta();
     }
 
-    // Método para mostrar historial
-    void mostrarHistorial() const {
-        cout << "\n=== HISTORIAL DE TRANSACCIONES - Cuenta #" << numero << " ===" << endl;
-        if (transacciones.empty()) {
-            cout << "No hay transacciones registradas" << endl;
-        } else {
-            for (const auto& trans : transacciones) {
-                trans->mostrarInfo();
+    // Anota un alta o una baja en el WAL (si hay persistencia) y espera a
+    // que esté en disco; false si no ha llegado. Lleva el último número de
+    // cuenta dado para que al recuperar no se reutilice el de una cuenta
+    // cerrada.
+    bool registrarCambio(TipoEventoBanco tipo, int32_t cuenta, int32_t extra,
+                         const string& nombreCliente, const string& dni) {
+        if (!registro.estaAbierto()) {
+            return true;
+        }
+        return registro.esperarDurable(registro.anotar(
+            EventoBanco{tipo, 0, cuenta, extra, ultimoNumero, marcaActual(),
+                        nombreCliente, dni}));
+    }
+
+    // Reconstruye clientes, cuentas e historiales desde un snapshot;
+    // devuelve la última secuencia del WAL incluida en él
+    bool cargarSnapshot(const string& ruta, uint64_t& ultimaSecuencia) {
+        ArchivoMapeado mapa(ruta);
+        if (!mapa.estaAbierto()) {
+            ultimaSecuencia = 0; // Primera ejecución: no hay snapshot
+            return true;
+        }
+        LectorBinario lector(mapa.getDatos(), mapa.getLongitud());
+        string magia;
+        uint64_t numClientes;
+        int32_t ultimoGuardado;
+        if (!lector.leerBytes(magia, 8) || magia != "BANSNAP2" || !lector.leer(ultimaSecuencia) ||
+            !lector.leer(ultimoGuardado) || !lector.leer(numClientes)) {
+            return false;
+        }
+        ultimoNumero = max(ultimoNumero, static_cast<int>(ultimoGuardado));
+        vector<MarcaTiempo> marcas;
+        vector<int64_t> movimientos;
+        vector<uint8_t> tipos;
+        for (uint64_t c = 0; c < numClientes; c++) {
+            string nombreCliente;
+            string dni;
+            uint64_t numCuentas;
+            if (!lector.leerTexto(nombreCliente) || !lector.leerTexto(dni) ||
+                !lector.leer(numCuentas)) {
+                return false;
+            }
+            Cliente* cliente = altaCliente(nombreCliente, dni);
+            int titular = ranuraCliente(dni);
+            for (uint64_t k = 0; k < numCuentas; k++) {
+                int32_t numero;
+                int32_t tipo;
+                if (!lector.leer(numero) || !lector.leer(tipo) || numero < 0 ||
+                    buscarCuenta(numero) ||
+                    !lector.leerVector(marcas) || !lector.leerVector(movimientos) ||
+                    !lector.leerVector(tipos) || movimientos.size() != marcas.size() ||
+                    tipos.size() != marcas.size()) {
+                    return false;
+                }
+                Manejador<Cuenta> m = cuentas.insertar(numero, static_cast<TipoCuenta>(tipo),
+                                                       nombreCliente, arena);
+                Cuenta* cuenta = altaCuenta(m, titular);
+                for (size_t i = 0; i < marcas.size(); i++) {
+                    int64_t c = movimientos[i];
+                    cuenta->repetir(static_cast<TipoTransaccion>(tipos[i]),
+                                    Dinero(c < 0 ? -c : c), marcas[i]);
+                }
+                cliente->vincularCuenta(m);
             }
         }
+        return lector.leerBytes(magia, 8) && magia == "FINSNAP1";
     }
-};
 
-// Inicializar contador estático
-int Cuenta::contadorCuentas = 0;
+    // Aplica un evento del WAL; devuelve false si no encaja con el estado
+    bool repetirEvento(const EventoBanco& e) {
+        Cuenta* cuenta = buscarCuenta(e.cuenta);
+        Dinero monto(e.centimos);
+        if (e.tipo == EVENTO_ALTA_CUENTA || e.tipo == EVENTO_BAJA_CUENTA) {
+            ultimoNumero = max(ultimoNumero, static_cast<int>(e.centimos));
+        }
+        switch (e.tipo) {
+        case EVENTO_ALTA_CLIENTE:
+            if (buscarCliente(e.dni)) {
+                return false;
+            }
+            altaCliente(e.nombre, e.dni);
+            return true;
+        case EVENTO_ALTA_CUENTA: {
+            Cliente* cliente = buscarCliente(e.dni);
+            if (!cliente || cuenta || e.cuenta < 0) {
+                return false;
+            }
+            Manejador<Cuenta> m = cuentas.insertar(e.cuenta, static_cast<TipoCuenta>(e.extra),
+                                                   cliente->getNombre(), arena);
+            altaCuenta(m, ranuraCliente(e.dni));
+            cliente->vincularCuenta(m);
+            return true;
+        }
+        case EVENTO_DEPOSITO:
+        case EVENTO_RETIRO:
+            if (!cuenta) {
+                return false;
+            }
+            cuenta->repetir(e.tipo == EVENTO_DEPOSITO ? DEPOSITO : RETIRO, monto, e.marca);
+            return true;
+        case EVENTO_TRANSFERENCIA: {
+            Cuenta* destino = buscarCuenta(e.extra);
+            if (!cuenta || !destino) {
+                return false;
+            }
+            cuenta->repetir(TRANSFERENCIA_ENVIADA, monto, e.marca);
+            destino->repetir(TRANSFERENCIA_RECIBIDA, monto, e.marca);
+            return true;
+        }
+        case EVENTO_BAJA_CUENTA:
+            if (!cuenta) {
+                return false;
+            }
+            bajaCuenta(e.cuenta);
+            return true;
+        case EVENTO_INTERES:
+        case EVENTO_COMISION:
+            if (!cuenta) {
+                return false;
+            }
+            cuenta->repetir(e.tipo == EVENTO_INTERES ? INTERES : COMISION, monto, e.marca);
+            return true;
+        }
+        return false;
+    }
 
-// ===== CLASE CLIENTE =====
-class Cliente {
-private:
-    string nombre;
-    string dni;
-    vector<shared_ptr<Cuenta>> cuentas;
+    // Escribe el snapshot en un archivo temporal, lo sincroniza y lo pone en
+    // el lugar del anterior con rename(), que es atómico: tras una caída
+    // queda el snapshot viejo o el nuevo, nunca uno a medias
+    bool guardarSnapshot(uint64_t ultimaSecuencia) const {
+        string temporal = rutaSnapshot + ".tmp";
+        FILE* archivo = fopen(temporal.c_str(), "wb");
+        if (!archivo) {
+            return false;
+        }
+        fwrite("BANSNAP2", 1, 8, archivo);
+        escribirValor<uint64_t>(archivo, ultimaSecuencia);
+        escribirValor<int32_t>(archivo, ultimoNumero);
+        escribirValor<uint64_t>(archivo, clientes.size());
+        clientes.recorrer([&](Manejador<Cliente>, const Cliente& cliente) {
+            escribirTexto(archivo, cliente.getNombre());
+            escribirTexto(archivo, cliente.getDni());
+            const vector<Manejador<Cuenta>>& propias = cliente.getCuentas();
+            escribirValor<uint64_t>(archivo, propias.size());
+            for (Manejador<Cuenta> m : propias) {
+                const Cuenta* cuenta = cuentas.obtener(m);
+                escribirValor<int32_t>(archivo, cuenta->getNumero());
+                escribirValor<int32_t>(archivo, cuenta->getTipo());
+                cuenta->guardarHistorial(archivo);
+            }
+        });
+        fwrite("FINSNAP1", 1, 8, archivo);
+        bool correcto = !ferror(archivo) && sincronizarArchivo(archivo);
+        correcto = (fclose(archivo) == 0) && correcto;
+        return correcto && rename(temporal.c_str(), rutaSnapshot.c_str()) == 0 &&
+               sincronizarDirectorio(rutaSnapshot);
+    }
 
 public:
-    Cliente(string n, string d) : nombre(n), dni(d) {}
+    Banco(string n) : nombre(n), ultimoNumero(0) {}
 
-    string getNombre() const { return nombre; }
-    string getDni() const { return dni; }
-    vector<shared_ptr<Cuenta>> getCuentas() const { return cuentas; }
-
-    // Método para agregar cuenta
-    void agregarCuenta(shared_ptr<Cuenta> cuenta) {
-        cuentas.push_back(cuenta);
-        cout << "Cuenta agregada al cliente " << nombre << endl;
+    // Prepara los índices para el número de clientes y cuentas previsto
+    void reservar(size_t numClientes, size_t numCuentas) {
+        clientes.reservar(numClientes);
+        cuentas.reservar(numCuentas);
+        indiceClientes.reservar(numClientes);
     }
 
-    // Método para mostrar información
-    void mostrarInfo() const {
-        cout << "Cliente: " << nombre << " (DNI: " << dni << ")" << endl;
-        cout << "Cuentas: " << cuentas.size() << endl;
-        for (const auto& cuenta : cuentas) {
-            cuenta->mostrarInfo();
-            cout << "---" << endl;
+    // Carga el último estado guardado (snapshot y WAL) y a partir de aquí
+    // anota cada operación en el WAL. Debe llamarse con el banco vacío.
+    // ventanaMicros es lo que espera cada fsync a reunir más operaciones.
+    bool activarPersistencia(const string& snapshot, const string& wal,
+                             unsigned ventanaMicros = 0) {
+        if (!clientes.empty() || registro.estaAbierto()) {
+            cout << "Error: La persistencia debe activarse con el banco vacío" << endl;
+            return false;
         }
+        rutaSnapshot = snapshot;
+        rutaRegistro = wal;
+        uint64_t ultimaSecuencia;
+        if (!cargarSnapshot(rutaSnapshot, ultimaSecuencia)) {
+            cout << "Error: Snapshot dañado: " << rutaSnapshot << endl;
+            return false;
+        }
+        // Los eventos ya incluidos en el snapshot se saltan (una caída entre
+        // guardar el snapshot y vaciar el WAL deja los dos)
+        vector<EventoBanco> eventos = RegistroBanco::leer(rutaRegistro);
+        for (const auto& e : eventos) {
+            if (e.secuencia <= ultimaSecuencia) {
+                continue;
+            }
+            if (e.secuencia != ultimaSecuencia + 1 || !repetirEvento(e)) {
+                cout << "Error: Evento #" << e.secuencia << " del WAL no aplicable" << endl;
+                return false;
+            }
+            ultimaSecuencia = e.secuencia;
+        }
+        // Todo lo recuperado pasa a un snapshot nuevo y el WAL empieza vacío
+        if (!guardarSnapshot(ultimaSecuencia) ||
+            !registro.abrir(rutaRegistro, ultimaSecuencia + 1, ventanaMicros)) {
+            cout << "Error: No se puede escribir en " << rutaSnapshot << " o " << rutaRegistro
+                 << endl;
+            return false;
+        }
+        cuentas.recorrer([this](Manejador<Cuenta>, Cuenta& cuenta) {
+            cuenta.setRegistro(&registro);
+        });
+        return true;
     }
-};
-
-// ===== CLASE BANCO =====
-class Banco {
-private:
-    string nombre;
-    vector<shared_ptr<Cliente>> clientes;
-    vector<shared_ptr<Cuenta>> cuentas;
 
-    // Método auxiliar para buscar cuenta
-    shared_ptr<Cuenta> buscarCuenta(int numero) {
-        for (auto& cuenta : cuentas) {
-            if (cuenta->getNumero() == numero) {
-                return cuenta;
-            }
+    // Guarda el estado en el snapshot y vacía el WAL. No debe haber
+    // operaciones en curso.
+    bool compactar() {
+        if (!registro.estaAbierto()) {
+            return false;
         }
-        return nullptr;
+        uint64_t ultimaSecuencia = registro.getUltimaSecuencia();
+        // Con el WAL fallido el estado en memoria incluye operaciones que se
+        // informaron como no guardadas; no se pasan al snapshot
+        if (!registro.esperarDurable(ultimaSecuencia)) {
+            cout << "Error: El WAL ha fallado, no se puede compactar" << endl;
+            return false;
+        }
+        return guardarSnapshot(ultimaSecuencia) &&
+               registro.abrir(rutaRegistro, ultimaSecuencia + 1, registro.getVentana());
     }
 
-    // Método auxiliar para buscar cliente
-    shared_ptr<Cliente> buscarCliente(string dni) {
-        for (auto& cliente : clientes) {
-            if (cliente->getDni() == dni) {
-                return cliente;
-            }
+    // Vigila los retiros de todas las cuentas (ver DetectorVelocidad). Como
+    // las altas, debe hacerse antes de empezar a operar.
+    void activarDetector(int maxRetiros, Dinero maxImporte, MarcaTiempo ventana = 600) {
+        detector.reset(new DetectorVelocidad(maxRetiros, maxImporte, ventana));
+        detector->admitir(ultimoNumero);
+        cuentas.recorrer([this](Manejador<Cuenta>, Cuenta& cuenta) {
+            cuenta.setDetector(detector.get());
+        });
+    }
+
+    // Método para mostrar las alertas de retiros
+    void mostrarAlertas() {
+        cout << "\n=== ALERTAS DE RETIROS ===" << endl;
+        if (!detector) {
+            cout << "Detector no activado" << endl;
+            return;
+        }
+        for (const auto& a : detector->getAlertas()) {
+            char fecha[LONGITUD_FECHA];
+            formatearMarca(a.marca, fecha);
+            cout << "[" << fecha << "] Cuenta #" << a.numeroCuenta << " - Retiros en "
+                 << detector->getVentana() / 60 << " min: " << a.retiros << " - Importe: $"
+                 << a.importe << endl;
         }
-        return nullptr;
     }
 
-public:
-    Banco(string n) : nombre(n) {}
+    RegistroBanco& getRegistro() { return registro; }
+    size_t getNumClientes() const { return clientes.size(); }
+    size_t getNumCuentas() const { return cuentas.size(); }
 
     // Método para registrar cliente
     void registrarCliente(string nombre, string dni) {
@@ -208,7 +2226,11 @@ public:
             cout << "Error: Cliente ya registrado" << endl;
             return;
         }
-        clientes.push_back(make_shared<Cliente>(nombre, dni));
+        altaCliente(nombre, dni);
+        if (!registrarCambio(EVENTO_ALTA_CLIENTE, 0, 0, nombre, dni)) {
+            cout << "Error: El alta de " << nombre << " no se pudo guardar en disco" << endl;
+            return;
+        }
         cout << "Cliente registrado: " << nombre << endl;
     }
 
@@ -220,14 +2242,311 @@ public:
             return -1;
         }
 
-        auto cuenta = make_shared<Cuenta>(tipo, cliente->getNombre());
-        cuentas.push_back(cuenta);
-        cliente->agregarCuenta(cuenta);
+        Manejador<Cuenta> m = cuentas.insertar(ultimoNumero + 1, tipo, cliente->getNombre(), arena);
+        Cuenta* cuenta = altaCuenta(m, ranuraCliente(dni));
+        cliente->agregarCuenta(m);
+        if (!registrarCambio(EVENTO_ALTA_CUENTA, cuenta->getNumero(), tipo, "", dni)) {
+            cout << "Error: La cuenta #" << cuenta->getNumero()
+                 << " no se pudo guardar en disco" << endl;
+            return -1;
+        }
         return cuenta->getNumero();
     }
 
+    // Método para cerrar una cuenta sin saldo. Su número no se reutiliza;
+    // su ranura sí, pero los manejadores antiguos ya no llevan a ella.
+    bool cerrarCuenta(int numeroCuenta) {
+        auto cuenta = buscarCuenta(numeroCuenta);
+        if (!cuenta) {
+            cout << "Error: Cuenta no encontrada" << endl;
+            return false;
+        }
+        if (cuenta->getSaldo() != Dinero()) {
+            cout << "Error: La cuenta aún tiene saldo" << endl;
+            return false;
+        }
+        bajaCuenta(numeroCuenta);
+        if (!registrarCambio(EVENTO_BAJA_CUENTA, numeroCuenta, 0, "", "")) {
+            cout << "Error: El cierre de la cuenta #" << numeroCuenta
+                 << " no se pudo guardar en disco" << endl;
+            return false;
+        }
+        cout << "Cuenta #" << numeroCuenta << " cerrada" << endl;
+        return true;
+    }
+
+    // Depósito sin mensajes, seguro entre hilos (secuencia: ver Cuenta)
+    ResultadoOperacion intentarDeposito(int numeroCuenta, Dinero monto,
+                                        uint64_t* secuencia = nullptr) {
+        auto cuenta = buscarCuenta(numeroCuenta);
+        return cuenta ? cuenta->intentarDeposito(monto, secuencia) : CUENTA_NO_ENCONTRADA;
+    }
+
+    // Retiro sin mensajes, seguro entre hilos
+    ResultadoOperacion intentarRetiro(int numeroCuenta, Dinero monto,
+                                      uint64_t* secuencia = nullptr) {
+        auto cuenta = buscarCuenta(numeroCuenta);
+        return cuenta ? cuenta->intentarRetiro(monto, secuencia) : CUENTA_NO_ENCONTRADA;
+    }
+
+    // Transferencia sin mensajes, segura entre hilos
+    ResultadoOperacion intentarTransferencia(int origen, int destino, Dinero monto,
+                                             uint64_t* secuencia = nullptr) {
+        auto cuentaOrigen = buscarCuenta(origen);
+        auto cuentaDestino = buscarCuenta(destino);
+        if (!cuentaOrigen || !cuentaDestino) {
+            return CUENTA_NO_ENCONTRADA;
+        }
+        return Cuenta::transferir(*cuentaOrigen, *cuentaDestino, monto, secuencia);
+    }
+
+    // Método para transferir dinero entre dos cuentas
+    bool transferir(int origen, int destino, Dinero monto) {
+        switch (intentarTransferencia(origen, destino, monto)) {
+        case CUENTA_NO_ENCONTRADA:
+            cout << "Error: Cuenta no encontrada" << endl;
+            return false;
+        case MONTO_INVALIDO:
+            cout << "Error: El monto debe ser mayor a 0" << endl;
+            return false;
+        case SALDO_INSUFICIENTE:
+            cout << "Error: Saldo insuficiente" << endl;
+            return false;
+        case MISMA_CUENTA:
+            cout << "Error: Las cuentas de origen y destino son la misma" << endl;
+            return false;
+        case DESBORDAMIENTO:
+            cout << "Error: El saldo superaría el máximo permitido" << endl;
+            return false;
+        case ERROR_PERSISTENCIA:
+            cout << "Error: La operación no se pudo guardar en disco" << endl;
+            return false;
+        default:
+            break;
+        }
+        cout << "Transferencia realizada: $" << monto
+             << " de la cuenta #" << origen << " a la #" << destino << endl;
+        return true;
+    }
+
+    // Suma de los saldos de todas las cuentas
+    Dinero saldoTotal() const {
+        Dinero total;
+        cuentas.recorrer([&total](Manejador<Cuenta>, const Cuenta& cuenta) {
+            total.sumar(cuenta.getSaldo());
+        });
+        return total;
+    }
+
+    // Conciliación: recalcula el saldo de cada cuenta desde su historial y
+    // devuelve las cuentas en las que no coincide con el guardado
+    vector<Descuadre> conciliar() const {
+        vector<Descuadre> descuadres;
+        cuentas.recorrer([&descuadres](Manejador<Cuenta>, const Cuenta& cuenta) {
+            Dinero calculado;
+            if (!cuenta.conciliar(calculado)) {
+                descuadres.push_back(Descuadre{cuenta.getNumero(), cuenta.getSaldo(), calculado});
+            }
+        });
+        return descuadres;
+    }
+
+    // Método para mostrar el resultado de la conciliación
+    void mostrarConciliacion() const {
+        cout << "\n=== CONCILIACIÓN DE SALDOS ===" << endl;
+        vector<Descuadre> descuadres = conciliar();
+        for (const auto& d : descuadres) {
+            cout << "Cuenta #" << d.numeroCuenta << " - Saldo: $" << d.saldo
+                 << " - Según historial: $" << d.calculado << endl;
+        }
+        cout << "Cuentas revisadas: " << cuentas.size()
+             << " - Descuadres: " << descuadres.size() << endl;
+    }
+
+    // Procesa un archivo de depósitos y retiros (ver LectorOperaciones) sin
+    // mensajes por operación. Las operaciones se reparten por número de
+    // cuenta entre varios hilos: todas las de una cuenta van al mismo hilo
+    // y en el orden del archivo, así que ningún hilo espera a otro y el
+    // resultado no depende del número de hilos. Con persistencia, cada hilo
+    // no espera al disco por operación: se espera una sola vez al final por
+    // la última secuencia del lote. En rutaResultados se
+    // escribe una línea "registro,resultado" por operación (registro
+    // empieza en 1 y no cuenta la cabecera).
+    ResumenLote procesarArchivo(const string& rutaOperaciones, const string& rutaResultados) {
+        ResumenLote resumen = {false, false, 0, 0, 0};
+        ArchivoMapeado archivo(rutaOperaciones);
+        if (!archivo.estaAbierto()) {
+            return resumen;
+        }
+        resumen.archivoAbierto = true;
+        vector<OperacionLote> operaciones =
+            LectorOperaciones(archivo.getDatos(), archivo.getLongitud()).analizar();
+        size_t n = operaciones.size();
+        resumen.operaciones = n;
+
+        // Reparto por cuenta conservando el orden del archivo
+        size_t particiones = max(1u, thread::hardware_concurrency());
+        particiones = min(particiones, n / 4096 + 1);
+        vector<ResultadoOperacion> resultados(n, FORMATO_INVALIDO);
+        vector<vector<size_t>> reparto(particiones);
+        for (size_t i = 0; i < n; i++) {
+            if (operaciones[i].valida) {
+                reparto[static_cast<size_t>(operaciones[i].cuenta) % particiones].push_back(i);
+            }
+        }
+
+        vector<thread> hilos;
+        vector<uint64_t> secuencias(n, 0); // Evento del WAL de cada operación
+        vector<uint64_t> ultimas(particiones, 0); // Última secuencia de cada hilo
+        for (size_t p = 0; p < particiones; p++) {
+            hilos.emplace_back([&, p]() {
+                for (size_t i : reparto[p]) {
+                    const OperacionLote& op = operaciones[i];
+                    auto cuenta = buscarCuenta(op.cuenta);
+                    if (!cuenta) {
+                        resultados[i] = CUENTA_NO_ENCONTRADA;
+                    } else if (op.tipo == DEPOSITO) {
+                        resultados[i] = cuenta->intentarDeposito(op.monto, &secuencias[i]);
+                    } else {
+                        resultados[i] = cuenta->intentarRetiro(op.monto, &secuencias[i]);
+                    }
+                    ultimas[p] = max(ultimas[p], secuencias[i]);
+                }
+            });
+        }
+        for (auto& hilo : hilos) {
+            hilo.join();
+        }
+        // Si el WAL falla, las operaciones que no llegaron al disco se
+        // informan como error aunque estén aplicadas en memoria
+        if (!registro.esperarDurable(*max_element(ultimas.begin(), ultimas.end()))) {
+            uint64_t durable = registro.getDurable();
+            for (size_t i = 0; i < n; i++) {
+                if (resultados[i] == OPERACION_OK && secuencias[i] > durable) {
+                    resultados[i] = ERROR_PERSISTENCIA;
+                }
+            }
+        }
+
+        // Archivo de resultados, escrito de una vez
+        string texto = "registro,resultado\n";
+        texto.reserve(texto.size() + n * 8);
+        for (size_t i = 0; i < n; i++) {
+            if (resultados[i] == OPERACION_OK) {
+                resumen.aplicadas++;
+            }
+            texto += to_string(i + 1);
+            texto += ',';
+            texto += nombreResultado(resultados[i]);
+            texto += '\n';
+        }
+        resumen.rechazadas = n - resumen.aplicadas;
+        FILE* salida = fopen(rutaResultados.c_str(), "wb");
+        if (salida) {
+            resumen.resultadosGuardados =
+                fwrite(texto.data(), 1, texto.size(), salida) == texto.size();
+            resumen.resultadosGuardados = (fclose(salida) == 0) && resumen.resultadosGuardados;
+        }
+        return resumen;
+    }
+
+    // Liquidación de fin de mes: intereses (saldo × tasaMensual) en las
+    // cuentas de ahorros y la comisión de mantenimiento en las corrientes,
+    // anotados como transacciones normales. Las cuentas se reparten por
+    // ranuras entre varios hilos; cada hilo copia los saldos de sus cuentas
+    // de ahorros a una columna contigua, calcula todos los intereses de una
+    // pasada vectorizada y después los abona. Los intereses se calculan con
+    // el saldo del momento de la copia. Con persistencia, se espera una
+    // sola vez al disco al final.
+    ResumenLiquidacion liquidarMes(double tasaMensual, Dinero comision) {
+        ResumenLiquidacion resumen = {0, 0, 0, Dinero(), Dinero(), 0.0, false};
+        if (!(tasaMensual >= 0.0 && tasaMensual < 1.0) || comision < Dinero()) {
+            cout << "Error: Tasa o comisión fuera de rango" << endl;
+            return resumen;
+        }
+        auto inicio = chrono::steady_clock::now();
+        size_t ranuras = cuentas.getNumRanuras();
+        size_t hilosMax = max(1u, thread::hardware_concurrency());
+        size_t numHilos = min(hilosMax, ranuras / 16384 + 1);
+        vector<ResumenLiquidacion> parciales(numHilos, resumen);
+        vector<uint64_t> ultimas(numHilos, 0);
+
+        vector<thread> hilos;
+        for (size_t h = 0; h < numHilos; h++) {
+            hilos.emplace_back([&, h]() {
+                ResumenLiquidacion& parcial = parciales[h];
+                uint64_t secuencia = 0;
+                vector<Cuenta*> ahorros;
+                vector<int64_t> saldos;
+                vector<Cuenta*> corrientes;
+                for (size_t i = ranuras * h / numHilos; i < ranuras * (h + 1) / numHilos; i++) {
+                    Cuenta* cuenta = cuentas.enRanura(static_cast<uint32_t>(i));
+                    if (!cuenta) {
+                        continue;
+                    }
+                    parcial.cuentas++;
+                    if (cuenta->getTipo() == AHORROS) {
+                        ahorros.push_back(cuenta);
+                        saldos.push_back(cuenta->getSaldo().getCentimos());
+                    } else {
+                        corrientes.push_back(cuenta);
+                    }
+                }
+
+                vector<int64_t> importes(saldos.size());
+                calcularIntereses(saldos.data(), importes.data(), saldos.size(), tasaMensual);
+                for (size_t k = 0; k < ahorros.size(); k++) {
+                    Dinero interes(importes[k]);
+                    if (interes > Dinero() &&
+                        ahorros[k]->abonarIntereses(interes, &secuencia) == OPERACION_OK) {
+                        parcial.abonos++;
+                        parcial.intereses.sumar(interes);
+                    }
+                }
+                if (comision > Dinero()) {
+                    for (Cuenta* cuenta : corrientes) {
+                        Dinero cobrado;
+                        if (cuenta->cobrarComision(comision, cobrado, &secuencia) == OPERACION_OK) {
+                            parcial.cargos++;
+                            parcial.comisiones.sumar(cobrado);
+                        }
+                    }
+                }
+                ultimas[h] = secuencia;
+            });
+        }
+        for (auto& hilo : hilos) {
+            hilo.join();
+        }
+        resumen.guardada = registro.esperarDurable(*max_element(ultimas.begin(), ultimas.end()));
+
+        for (const auto& parcial : parciales) {
+            resumen.cuentas += parcial.cuentas;
+            resumen.abonos += parcial.abonos;
+            resumen.cargos += parcial.cargos;
+            resumen.intereses.sumar(parcial.intereses);
+            resumen.comisiones.sumar(parcial.comisiones);
+        }
+        resumen.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        return resumen;
+    }
+
+    // Método para mostrar el resultado de la liquidación mensual
+    void mostrarLiquidacion(double tasaMensual, Dinero comision) {
+        cout << "\n=== LIQUIDACIÓN MENSUAL ===" << endl;
+        ResumenLiquidacion r = liquidarMes(tasaMensual, comision);
+        cout << "Cuentas: " << r.cuentas << " - Con intereses: " << r.abonos
+             << " ($" << r.intereses << ") - Con comisión: " << r.cargos
+             << " ($" << r.comisiones << ")" << endl;
+        cout << "Cuentas/s: " << fixed << setprecision(0)
+             << r.cuentas / max(r.segundos, 1e-9) << endl;
+        if (!r.guardada) {
+            cout << "Error: La liquidación no se pudo guardar en disco" << endl;
+        }
+    }
+
     // Método para realizar depósito
-    bool depositar(int numeroCuenta, double monto) {
+    bool depositar(int numeroCuenta, Dinero monto) {
         auto cuenta = buscarCuenta(numeroCuenta);
         if (!cuenta) {
             cout << "Error: Cuenta no encontrada" << endl;
@@ -237,7 +2556,7 @@ public:
     }
 
     // Método para realizar retiro
-    bool retirar(int numeroCuenta, double monto) {
+    bool retirar(int numeroCuenta, Dinero monto) {
         auto cuenta = buscarCuenta(numeroCuenta);
         if (!cuenta) {
             cout << "Error: Cuenta no encontrada" << endl;
@@ -246,6 +2565,22 @@ public:
         return cuenta->retirar(monto);
     }
 
+    // Saldo de una cuenta sin mensajes; false si no existe
+    bool obtenerSaldo(int numeroCuenta, Dinero& saldo) const {
+        auto cuenta = buscarCuenta(numeroCuenta);
+        if (!cuenta) {
+            return false;
+        }
+        saldo = cuenta->getSaldo();
+        return true;
+    }
+
+    // Número de cuentas de un cliente, o -1 si no existe
+    int contarCuentasDe(const string& dni) const {
+        auto cliente = buscarCliente(dni);
+        return cliente ? static_cast<int>(cliente->getCuentas().size()) : -1;
+    }
+
     // Método para consultar saldo
     void consultarSaldo(int numeroCuenta) {
         auto cuenta = buscarCuenta(numeroCuenta);
@@ -256,6 +2591,34 @@ public:
         cuenta->mostrarInfo();
     }
 
+    // Método para consultar el saldo que tenía una cuenta en una fecha
+    void consultarSaldoEn(int numeroCuenta, MarcaTiempo instante) {
+        auto cuenta = buscarCuenta(numeroCuenta);
+        if (!cuenta) {
+            cout << "Error: Cuenta no encontrada" << endl;
+            return;
+        }
+        char fecha[LONGITUD_FECHA];
+        formatearMarca(instante, fecha);
+        cout << "Saldo de la cuenta #" << numeroCuenta << " a " << fecha << ": $"
+             << cuenta->saldoEn(instante) << endl;
+    }
+
+    // Método para consultar la variación neta del saldo entre dos fechas
+    void consultarFlujo(int numeroCuenta, MarcaTiempo desde, MarcaTiempo hasta) {
+        auto cuenta = buscarCuenta(numeroCuenta);
+        if (!cuenta) {
+            cout << "Error: Cuenta no encontrada" << endl;
+            return;
+        }
+        char inicio[LONGITUD_FECHA];
+        char fin[LONGITUD_FECHA];
+        formatearMarca(desde, inicio);
+        formatearMarca(hasta, fin);
+        cout << "Flujo neto de la cuenta #" << numeroCuenta << " entre " << inicio
+             << " y " << fin << ": $" << cuenta->flujoEntre(desde, hasta) << endl;
+    }
+
     // Método para mostrar historial
     void mostrarHistorial(int numeroCuenta) {
         auto cuenta = buscarCuenta(numeroCuenta);
@@ -269,13 +2632,178 @@ public:
     // Método para mostrar todos los clientes
     void mostrarClientes() const {
         cout << "\n=== CLIENTES DEL BANCO " << nombre << " ===" << endl;
-        for (const auto& cliente : clientes) {
-            cliente->mostrarInfo();
+        clientes.recorrer([this](Manejador<Cliente>, const Cliente& cliente) {
+            cliente.mostrarInfo(cuentas);
             cout << "---" << endl;
-        }
+        });
     }
 };
 
+// ===== BÚSQUEDAS CON MUCHAS CUENTAS =====
+// Abre numCuentas cuentas (diez por cliente) y mide el tiempo medio de
+// buscar una cuenta por número y un cliente por DNI, al azar. Con los
+// índices no debe depender del número de cuentas; lo que crece es solo
+// el coste de los fallos de caché al tocar la cuenta o el cliente.
+void medirBusquedas(size_t numCuentas) {
+    Banco banco("Banco Grande");
+    size_t numClientes = numCuentas / 10;
+    banco.reservar(numClientes, numCuentas);
+    vector<string> dnis(numClientes);
+    vector<int> numeros;
+    numeros.reserve(numCuentas);
+    cout.setstate(ios::failbit); // Sin los mensajes de alta
+    for (size_t c = 0; c < numClientes; c++) {
+        char dni[24];
+        snprintf(dni, sizeof(dni), "%08zuB", c);
+        dnis[c] = dni;
+        banco.registrarCliente("Cliente " + to_string(c), dnis[c]);
+        for (int k = 0; k < 10; k++) {
+            numeros.push_back(banco.crearCuenta(dnis[c], k % 2 ? CORRIENTE : AHORROS));
+        }
+    }
+    cout.clear();
+
+    const int BUSQUEDAS = 1000000;
+    mt19937 azar(9);
+    vector<int> porNumero(BUSQUEDAS);
+    vector<const string*> porDni(BUSQUEDAS);
+    for (int i = 0; i < BUSQUEDAS; i++) {
+        porNumero[i] = numeros[azar() % numCuentas];
+        porDni[i] = &dnis[azar() % numClientes];
+    }
+
+    size_t encontradas = 0;
+    auto inicio = chrono::steady_clock::now();
+    for (int numero : porNumero) {
+        Dinero saldo;
+        encontradas += banco.obtenerSaldo(numero, saldo);
+    }
+    auto cuentasHechas = chrono::steady_clock::now();
+    for (const string* dni : porDni) {
+        encontradas += banco.contarCuentasDe(*dni) == 10;
+    }
+    auto fin = chrono::steady_clock::now();
+
+    auto ns = [BUSQUEDAS](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, nano>(b - a).count() / BUSQUEDAS;
+    };
+    cout << "Cuentas: " << numCuentas << " - Por número: " << fixed << setprecision(0)
+         << ns(inicio, cuentasHechas) << " ns - Por DNI: " << ns(cuentasHechas, fin) << " ns"
+         << (encontradas == 2 * static_cast<size_t>(BUSQUEDAS) ? "" : " (ERROR)") << endl;
+}
+
+// ===== SIMULACIÓN DE CAJEROS =====
+// Cada hilo es un cajero que hace transferencias al azar entre las cuentas
+// indicadas. Las transferencias no crean ni destruyen dinero, así que la
+// suma de saldos debe ser la misma antes y después.
+void simularCajeros(Banco& banco, const vector<int>& cuentas, int cajeros, int operaciones) {
+    Dinero totalInicial = banco.saldoTotal();
+    atomic<int> realizadas(0);
+    vector<thread> hilos;
+
+    auto inicio = chrono::steady_clock::now();
+    for (int c = 0; c < cajeros; c++) {
+        hilos.emplace_back([&, c]() {
+            mt19937 azar(static_cast<unsigned>(c + 1));
+            uniform_int_distribution<size_t> elegir(0, cuentas.size() - 1);
+            uniform_int_distribution<int64_t> importe(1, 5000); // Céntimos
+            int propias = 0;
+            for (int i = 0; i < operaciones / cajeros; i++) {
+                int origen = cuentas[elegir(azar)];
+                int destino = cuentas[elegir(azar)];
+                if (banco.intentarTransferencia(origen, destino, Dinero(importe(azar))) == OPERACION_OK) {
+                    propias++;
+                }
+            }
+            realizadas += propias;
+        });
+    }
+    for (auto& hilo : hilos) {
+        hilo.join();
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    Dinero totalFinal = banco.saldoTotal();
+    cout << "Cajeros: " << cajeros << " - Transferencias: " << realizadas
+         << " - Operaciones/s: " << fixed << setprecision(0) << operaciones / segundos
+         << " - Total: $" << totalInicial << " -> $" << totalFinal
+         << (totalInicial == totalFinal ? " (conservado)" : " (ERROR)") << endl;
+}
+
+// ===== OPERACIONES DURABLES =====
+// Cada cajero hace depósitos en su cuenta y espera a que estén en disco
+// cada "lote" operaciones (con lote 1, tras cada una). Cuantos más cajeros
+// esperan a la vez, más operaciones entran en cada fsync.
+void medirDurabilidad(Banco& banco, const vector<int>& cuentas, int cajeros,
+                      unsigned ventanaMicros, int lote, int operaciones) {
+    RegistroBanco& registro = banco.getRegistro();
+    registro.setVentana(ventanaMicros);
+    uint64_t gruposIniciales = registro.getGrupos();
+    atomic<bool> fallo(false);
+    vector<thread> hilos;
+
+    auto inicio = chrono::steady_clock::now();
+    for (int c = 0; c < cajeros; c++) {
+        hilos.emplace_back([&, c]() {
+            int numero = cuentas[static_cast<size_t>(c) % cuentas.size()];
+            uint64_t secuencia = 0;
+            for (int i = 0; i < operaciones / cajeros; i++) {
+                banco.intentarDeposito(numero, Dinero(1), &secuencia);
+                if ((i + 1) % lote == 0 && !registro.esperarDurable(secuencia)) {
+                    fallo = true;
+                    return;
+                }
+            }
+            if (!registro.esperarDurable(secuencia)) {
+                fallo = true;
+            }
+        });
+    }
+    for (auto& hilo : hilos) {
+        hilo.join();
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    uint64_t grupos = registro.getGrupos() - gruposIniciales;
+    cout << "Cajeros: " << cajeros << " - Lote: " << lote << " - Ventana: " << ventanaMicros
+         << " us - Operaciones/s: " << fixed << setprecision(0) << operaciones / segundos
+         << " - Operaciones por fsync: " << setprecision(1)
+         << static_cast<double>(operaciones) / max<uint64_t>(grupos, 1) << endl;
+    if (fallo) {
+        cout << "Error: Parte de las operaciones no se pudo guardar en disco" << endl;
+    }
+}
+
+// ===== REPRODUCCIÓN DE RETIROS =====
+// Pasa por el detector, en un solo hilo, un flujo de retiros al azar ya
+// generado (unos 1000 por segundo repartidos entre las cuentas) y mide
+// cuántos eventos por segundo evalúa.
+void reproducirRetiros(int numCuentas, int eventos) {
+    DetectorVelocidad detector(5, Dinero::importe(2000.00));
+    detector.admitir(numCuentas - 1);
+    mt19937 azar(42);
+    uniform_int_distribution<int> elegir(0, numCuentas - 1);
+    uniform_int_distribution<int64_t> importe(100, 50000); // Céntimos
+    vector<int> cuentas(eventos);
+    vector<int64_t> importes(eventos);
+    vector<MarcaTiempo> marcas(eventos);
+    MarcaTiempo inicioFlujo = marcaActual();
+    for (int i = 0; i < eventos; i++) {
+        cuentas[i] = elegir(azar);
+        importes[i] = importe(azar);
+        marcas[i] = inicioFlujo + i / 1000;
+    }
+
+    auto inicio = chrono::steady_clock::now();
+    for (int i = 0; i < eventos; i++) {
+        detector.observar(cuentas[i], Dinero(importes[i]), marcas[i]);
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cout << "Cuentas: " << numCuentas << " - Eventos: " << eventos
+         << " - Eventos/s: " << fixed << setprecision(0) << eventos / segundos
+         << " - Alertas: " << detector.getNumAlertas() << endl;
+}
+
 // ===== FUNCIÓN MAIN - DEMOSTRACIÓN =====
 int main() {
     // Crear banco
@@ -285,6 +2813,7 @@ int main() {
     cout << "=== REGISTRANDO CLIENTES ===" << endl;
     banco.registrarCliente("Ana López", "12345678A");
     banco.registrarCliente("Carlos Ruiz", "87654321B");
+    banco.registrarCliente("Ana López", "12345678A"); // Duplicado
 
     // Crear cuentas
     cout << "\n=== CREANDO CUENTAS ===" << endl;
@@ -294,11 +2823,11 @@ int main() {
 
     // Realizar operaciones
     cout << "\n=== REALIZANDO OPERACIONES ===" << endl;
-    banco.depositar(cuenta1, 1000.50);
-    banco.depositar(cuenta2, 2500.75);
-    banco.depositar(cuenta3, 500.00);
-    banco.retirar(cuenta1, 200.25);
-    banco.depositar(cuenta2, 100.00);
+    banco.depositar(cuenta1, Dinero::importe(1000.50));
+    banco.depositar(cuenta2, Dinero::importe(2500.75));
+    banco.depositar(cuenta3, Dinero::importe(500.00));
+    banco.retirar(cuenta1, Dinero::importe(200.25));
+    banco.depositar(cuenta2, Dinero::importe(100.00));
 
     // Consultar saldos
     cout << "\n=== CONSULTANDO SALDOS ===" << endl;
@@ -309,9 +2838,156 @@ int main() {
     banco.mostrarHistorial(cuenta1);
     banco.mostrarHistorial(cuenta2);
 
+    // Saldos en fechas pasadas (ayer aún no había operaciones)
+    cout << "\n=== CONSULTAS HISTÓRICAS ===" << endl;
+    MarcaTiempo ahora = marcaActual();
+    banco.consultarSaldoEn(cuenta1, ahora - 24 * 3600);
+    banco.consultarSaldoEn(cuenta1, ahora);
+    banco.consultarFlujo(cuenta2, ahora - 24 * 3600, ahora);
+
+    // Transferencias
+    cout << "\n=== TRANSFERENCIAS ===" << endl;
+    banco.transferir(cuenta2, cuenta1, Dinero::importe(300.00));
+    banco.transferir(cuenta3, cuenta1, Dinero::importe(9999.00)); // Saldo insuficiente
+
+    // Importes en céntimos exactos, con control de desbordamiento
+    cout << "\n=== LÍMITES DE IMPORTE ===" << endl;
+    banco.depositar(cuenta3, Dinero(INT64_MAX)); // El saldo ya no cabría
+
+    // Una cuenta cerrada deja de encontrarse aunque otra ocupe su ranura
+    cout << "\n=== CIERRE DE CUENTAS ===" << endl;
+    int temporal = banco.crearCuenta("87654321B", AHORROS);
+    banco.cerrarCuenta(cuenta2); // Aún tiene saldo
+    banco.cerrarCuenta(temporal);
+    banco.depositar(temporal, Dinero::importe(10.00)); // Ya no existe
+    int nueva = banco.crearCuenta("87654321B", AHORROS);
+    banco.consultarSaldo(nueva);
+
     // Mostrar todos los clientes
     banco.mostrarClientes();
 
+    // Búsquedas por número de cuenta y por DNI hasta 10 millones de cuentas
+    cout << "\n=== BÚSQUEDAS CON MUCHAS CUENTAS ===" << endl;
+    for (size_t cuentas = 100000; cuentas <= 10000000; cuentas *= 10) {
+        medirBusquedas(cuentas);
+    }
+
+    // Varios cajeros transfiriendo a la vez entre las mismas cuentas
+    cout << "\n=== CAJEROS CONCURRENTES ===" << endl;
+    banco.registrarCliente("Tesorería", "00000000T");
+    vector<int> tesoreria;
+    for (int i = 0; i < 16; i++) {
+        int numero = banco.crearCuenta("00000000T", CORRIENTE);
+        banco.intentarDeposito(numero, Dinero::importe(1000.00));
+        tesoreria.push_back(numero);
+    }
+    for (int cajeros = 1; cajeros <= 8; cajeros *= 2) {
+        simularCajeros(banco, tesoreria, cajeros, 400000);
+    }
+
+    // Lote nocturno de operaciones desde archivo
+    cout << "\n=== LOTE DE OPERACIONES ===" << endl;
+    {
+        ofstream lote("lote_demo.csv");
+        lote << "cuenta,tipo,importe\n"
+             << cuenta1 << ",D,150.00\n"
+             << cuenta1 << ",R,50.25\n"
+             << cuenta3 << ",R,100000.00\n"   // Saldo insuficiente
+             << "999,D,10.00\n"                // Cuenta inexistente
+             << cuenta2 << ",X,1.00\n"        // Tipo desconocido
+             << cuenta2 << ",RETIRO,0.75\n";
+    }
+    ResumenLote resumen = banco.procesarArchivo("lote_demo.csv", "lote_demo.resultados");
+    cout << "Operaciones: " << resumen.operaciones << " - Aplicadas: " << resumen.aplicadas
+         << " - Rechazadas: " << resumen.rechazadas << endl;
+    {
+        ifstream resultados("lote_demo.resultados");
+        string linea;
+        while (getline(resultados, linea)) {
+            cout << linea << endl;
+        }
+    }
+    remove("lote_demo.csv");
+    remove("lote_demo.resultados");
+
+    // Fin de mes: 0,25 % de interés en ahorros y 2,50 de comisión en corrientes
+    banco.mostrarLiquidacion(0.0025, Dinero::importe(2.50));
+    banco.mostrarHistorial(cuenta1);
+
+    // Vigilancia de retiros: más de 3 o más de $500 en 10 minutos
+    cout << "\n=== VIGILANCIA DE RETIROS ===" << endl;
+    banco.activarDetector(3, Dinero::importe(500.00));
+    for (int i = 0; i < 5; i++) {
+        banco.retirar(cuenta2, Dinero::importe(20.00)); // El cuarto abre la alerta
+    }
+    banco.transferir(cuenta1, cuenta3, Dinero::importe(600.00)); // Supera el importe
+    banco.mostrarAlertas();
+    reproducirRetiros(100000, 2000000);
+
+    // Cierre del día: cada saldo debe coincidir con su historial
+    banco.mostrarConciliacion();
+
+    // Snapshot + WAL: lo hecho tras el último snapshot se recupera del WAL,
+    // aunque el final del WAL quede cortado por una caída
+    cout << "\n=== PERSISTENCIA Y RECUPERACIÓN ===" << endl;
+    remove("banco_demo.snap");
+    remove("banco_demo.wal");
+    {
+        Banco sucursal("Sucursal Centro");
+        sucursal.activarPersistencia("banco_demo.snap", "banco_demo.wal");
+        sucursal.registrarCliente("Lucía Gómez", "55555555L");
+        int ahorro = sucursal.crearCuenta("55555555L", AHORROS);
+        int corriente = sucursal.crearCuenta("55555555L", CORRIENTE);
+        sucursal.depositar(ahorro, Dinero::importe(800.00));
+        sucursal.transferir(ahorro, corriente, Dinero::importe(125.50));
+        sucursal.compactar(); // Hasta aquí, en el snapshot
+        sucursal.retirar(corriente, Dinero::importe(25.50));
+        sucursal.depositar(ahorro, Dinero::importe(10.00)); // Esto, solo en el WAL
+        sucursal.cerrarCuenta(sucursal.crearCuenta("55555555L", AHORROS));
+    }
+    {
+        FILE* wal = fopen("banco_demo.wal", "ab");
+        if (wal) {
+            fwrite("\x40\x00\x00", 1, 3, wal); // Registro a medio escribir
+            fclose(wal);
+        }
+    }
+    {
+        Banco sucursal("Sucursal Centro");
+        if (sucursal.activarPersistencia("banco_demo.snap", "banco_demo.wal")) {
+            cout << "Recuperado: " << sucursal.getNumClientes() << " cliente(s), "
+                 << sucursal.getNumCuentas() << " cuenta(s) - Total: $" << sucursal.saldoTotal()
+                 << endl;
+            sucursal.mostrarClientes();
+            sucursal.mostrarConciliacion();
+        }
+    }
+    remove("banco_demo.snap");
+    remove("banco_demo.wal");
+
+    // Confirmación en grupo: los cajeros que esperan a la vez comparten fsync
+    cout << "\n=== OPERACIONES DURABLES ===" << endl;
+    remove("durable_demo.snap");
+    remove("durable_demo.wal");
+    {
+        Banco durable("Banco Durable");
+        durable.activarPersistencia("durable_demo.snap", "durable_demo.wal");
+        durable.registrarCliente("Caja", "11111111C");
+        vector<int> cajas;
+        for (int i = 0; i < 8; i++) {
+            cajas.push_back(durable.crearCuenta("11111111C", CORRIENTE));
+        }
+        for (unsigned ventana : {0u, 200u}) {
+            for (int cajeros : {1, 8}) {
+                for (int lote : {1, 16}) {
+                    medirDurabilidad(durable, cajas, cajeros, ventana, lote, 2000);
+                }
+            }
+        }
+    }
+    remove("durable_demo.snap");
+    remove("durable_demo.wal");
+
     return 0;
 }
 
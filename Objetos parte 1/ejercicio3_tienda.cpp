@@ -31,52 +31,454 @@
 #include <memory>
 #include <ctime>
 #include <iomanip>
-#include <sstream>
+#include <cstdint>
+#include <cstring>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
 // ===== ENUMS =====
 enum TipoCliente { REGULAR, PREMIUM };
 
+enum ResultadoReserva {
+    RESERVA_OK,
+    PEDIDO_NO_ENCONTRADO,
+    PRODUCTO_NO_ENCONTRADO,
+    CANTIDAD_INVALIDA,
+    STOCK_INSUFICIENTE,
+    TOTAL_EXCEDIDO
+};
+
+// ===== CLASE DINERO =====
+// Importe en céntimos como entero de 64 bits: sumas y restas exactas, sin
+// el error de redondeo de double. Las operaciones que pueden desbordar
+// devuelven false y dejan el valor como estaba.
+class Dinero {
+private:
+    int64_t centimos;
+
+public:
+    Dinero() : centimos(0) {}
+    explicit Dinero(int64_t c) : centimos(c) {}
+
+    // Importe escrito con decimales (999.99); se redondea al céntimo
+    static Dinero importe(double valor) {
+        return Dinero(static_cast<int64_t>(llround(valor * 100.0)));
+    }
+
+    int64_t getCentimos() const { return centimos; }
+
+    // Suma otro importe; false si el resultado no cabe en 64 bits
+    bool sumar(Dinero otro) {
+        int64_t r;
+#if defined(__GNUC__)
+        if (__builtin_add_overflow(centimos, otro.centimos, &r)) {
+            return false;
+        }
+#else
+        if ((otro.centimos > 0 && centimos > INT64_MAX - otro.centimos) ||
+            (otro.centimos < 0 && centimos < INT64_MIN - otro.centimos)) {
+            return false;
+        }
+        r = centimos + otro.centimos;
+#endif
+        centimos = r;
+        return true;
+    }
+
+    // Resta otro importe; false si el resultado no cabe en 64 bits
+    bool restar(Dinero otro) {
+        int64_t r;
+#if defined(__GNUC__)
+        if (__builtin_sub_overflow(centimos, otro.centimos, &r)) {
+            return false;
+        }
+#else
+        if ((otro.centimos < 0 && centimos > INT64_MAX + otro.centimos) ||
+            (otro.centimos > 0 && centimos < INT64_MIN + otro.centimos)) {
+            return false;
+        }
+        r = centimos - otro.centimos;
+#endif
+        centimos = r;
+        return true;
+    }
+
+    // Multiplica por un entero; false si el resultado no cabe en 64 bits
+    bool multiplicar(int64_t factor) {
+        int64_t r;
+#if defined(__GNUC__)
+        if (__builtin_mul_overflow(centimos, factor, &r)) {
+            return false;
+        }
+#else
+        if (factor != 0 && (centimos > INT64_MAX / factor || centimos < INT64_MIN / factor)) {
+            return false;
+        }
+        r = centimos * factor;
+#endif
+        centimos = r;
+        return true;
+    }
+
+    // Porcentaje (0-100) de un importe no negativo, redondeado al céntimo
+    // (las mitades hacia arriba); no desborda
+    Dinero porcentaje(int tanto) const {
+        return Dinero((centimos / 100) * tanto + ((centimos % 100) * tanto + 50) / 100);
+    }
+
+    bool operator==(Dinero otro) const { return centimos == otro.centimos; }
+    bool operator!=(Dinero otro) const { return centimos != otro.centimos; }
+    bool operator<(Dinero otro) const { return centimos < otro.centimos; }
+    bool operator>(Dinero otro) const { return centimos > otro.centimos; }
+
+    // Se muestra con dos decimales, como 1234.56
+    friend ostream& operator<<(ostream& salida, Dinero d) {
+        uint64_t absoluto = (d.centimos < 0) ? 0 - static_cast<uint64_t>(d.centimos)
+                                             : static_cast<uint64_t>(d.centimos);
+        char texto[32];
+        snprintf(texto, sizeof(texto), "%s%llu.%02llu", (d.centimos < 0) ? "-" : "",
+                 static_cast<unsigned long long>(absoluto / 100),
+                 static_cast<unsigned long long>(absoluto % 100));
+        return salida << texto;
+    }
+};
+
+// ===== MARCAS DE TIEMPO =====
+// Instante en segundos desde 1970-01-01 (UTC). Se toma con time(), sin
+// localtime ni flujos, y solo se convierte a texto cuando se muestra.
+typedef int64_t MarcaTiempo;
+
+const size_t LONGITUD_FECHA = 20; // "AAAA-MM-DD HH:MM:SS" más el '\0'
+
+inline MarcaTiempo marcaActual() {
+    return static_cast<MarcaTiempo>(time(nullptr));
+}
+
+// Escribe la marca en hora local en destino (LONGITUD_FECHA bytes). Cada
+// hilo guarda el texto del último segundo formateado: las operaciones
+// hechas en el mismo segundo reutilizan la fecha sin llamar a localtime_r.
+inline void formatearMarca(MarcaTiempo marca, char* destino) {
+    static thread_local MarcaTiempo segundo = INT64_MIN;
+    static thread_local char texto[LONGITUD_FECHA];
+    if (marca != segundo) {
+        time_t t = static_cast<time_t>(marca);
+        tm partes;
+#if defined(_WIN32)
+        localtime_s(&partes, &t);
+#else
+        localtime_r(&t, &partes);
+#endif
+        strftime(texto, sizeof(texto), "%Y-%m-%d %H:%M:%S", &partes);
+        segundo = marca;
+    }
+    memcpy(destino, texto, LONGITUD_FECHA);
+}
+
+inline string formatearMarca(MarcaTiempo marca) {
+    char texto[LONGITUD_FECHA];
+    formatearMarca(marca, texto);
+    return texto;
+}
+
+// ===== CONSULTAS VECTORIZADAS DE INVENTARIO =====
+// Recorridos de columnas de inventario con AVX2 o SSE2 cuando la CPU los
+// tiene, y un bucle normal si no. Cada versión vectorizada da exactamente
+// el mismo resultado que la escalar.
+#if defined(__SSE2__) || defined(_M_X64)
+#define INVENTARIO_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INVENTARIO_AVX2 1
+#endif
+
+// Posiciones con stock por debajo del umbral; devuelve cuántas escribió
+// (posiciones debe tener sitio para n)
+inline size_t buscarBajoUmbralEscalar(const int32_t* stock, size_t n, int32_t umbral,
+                                      uint32_t* posiciones, size_t base = 0) {
+    size_t encontradas = 0;
+    for (size_t i = 0; i < n; i++) {
+        posiciones[encontradas] = static_cast<uint32_t>(base + i);
+        encontradas += stock[i] < umbral ? 1 : 0;
+    }
+    return encontradas;
+}
+
+// Valor del inventario: suma de precio × stock, módulo 2^64 como la suma
+// de saldos del banco. Las versiones vectorizadas multiplican con
+// instrucciones de 32 × 32 bits, así que los bloques con algún precio o
+// stock fuera de [0, 2^31) van por el bucle escalar.
+const uint64_t BITS_FUERA_DE_32 = 0xFFFFFFFF80000000ULL;
+
+inline uint64_t valorarEscalar(const int64_t* precios, const int32_t* stock, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += static_cast<uint64_t>(precios[i]) * static_cast<uint64_t>(static_cast<int64_t>(stock[i]));
+    }
+    return total;
+}
+
+// Precio × factor redondeado al céntimo (las mitades al par), con el mismo
+// truco de 2^52 que los intereses del banco. Vale para precios entre 0 y
+// 2^51 céntimos y factores entre 0 y 2 (el resultado queda por debajo de
+// 2^52); los precios que se salen van por el bucle escalar.
+const uint64_t BITS_FUERA_DE_51 = 0xFFF8000000000000ULL;
+const double DOS_A_LA_52 = 4503599627370496.0;
+
+inline void ajustarPreciosEscalar(int64_t* precios, size_t n, double factor) {
+    for (size_t i = 0; i < n; i++) {
+        precios[i] = static_cast<int64_t>(nearbyint(static_cast<double>(precios[i]) * factor));
+    }
+}
+
+#if defined(INVENTARIO_SSE2)
+inline size_t buscarBajoUmbralSSE2(const int32_t* stock, size_t n, int32_t umbral,
+                                   uint32_t* posiciones) {
+    const __m128i limite = _mm_set1_epi32(umbral);
+    size_t encontradas = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stock + i));
+        unsigned mascara = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(s, limite))));
+        while (mascara) {
+            posiciones[encontradas++] = static_cast<uint32_t>(i + __builtin_ctz(mascara));
+            mascara &= mascara - 1;
+        }
+    }
+    return encontradas + buscarBajoUmbralEscalar(stock + i, n - i, umbral, posiciones + encontradas, i);
+}
+
+inline uint64_t valorarSSE2(const int64_t* precios, const int32_t* stock, size_t n) {
+    const __m128i fuera = _mm_set1_epi64x(static_cast<int64_t>(BITS_FUERA_DE_32));
+    __m128i total = _mm_setzero_si128();
+    uint64_t resto = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(precios + i));
+        __m128i s = _mm_unpacklo_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(stock + i)),
+                                       _mm_setzero_si128());
+        __m128i altos = _mm_and_si128(_mm_or_si128(p, s), fuera);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(altos, _mm_setzero_si128())) != 0xFFFF) {
+            resto += valorarEscalar(precios + i, stock + i, 2);
+            continue;
+        }
+        total = _mm_add_epi64(total, _mm_mul_epu32(p, s));
+    }
+    uint64_t partes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(partes), total);
+    return partes[0] + partes[1] + resto + valorarEscalar(precios + i, stock + i, n - i);
+}
+
+inline void ajustarPreciosSSE2(int64_t* precios, size_t n, double factor) {
+    const __m128i exponente = _mm_set1_epi64x(0x4330000000000000LL);
+    const __m128i fuera = _mm_set1_epi64x(static_cast<int64_t>(BITS_FUERA_DE_51));
+    const __m128i mantisa = _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m128d desplazamiento = _mm_set1_pd(DOS_A_LA_52);
+    const __m128d multiplicador = _mm_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(precios + i));
+        __m128i altos = _mm_and_si128(p, fuera);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(altos, _mm_setzero_si128())) != 0xFFFF) {
+            ajustarPreciosEscalar(precios + i, 2, factor);
+            continue;
+        }
+        __m128d d = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(p, exponente)), desplazamiento);
+        __m128d r = _mm_add_pd(_mm_mul_pd(d, multiplicador), desplazamiento);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(precios + i),
+                         _mm_and_si128(_mm_castpd_si128(r), mantisa));
+    }
+    ajustarPreciosEscalar(precios + i, n - i, factor);
+}
+#endif
+
+#if defined(INVENTARIO_AVX2)
+__attribute__((target("avx2")))
+inline size_t buscarBajoUmbralAVX2(const int32_t* stock, size_t n, int32_t umbral,
+                                   uint32_t* posiciones) {
+    const __m256i limite = _mm256_set1_epi32(umbral);
+    size_t encontradas = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stock + i));
+        unsigned mascara = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(limite, s))));
+        while (mascara) {
+            posiciones[encontradas++] = static_cast<uint32_t>(i + __builtin_ctz(mascara));
+            mascara &= mascara - 1;
+        }
+    }
+    return encontradas + buscarBajoUmbralEscalar(stock + i, n - i, umbral, posiciones + encontradas, i);
+}
+
+__attribute__((target("avx2")))
+inline uint64_t valorarAVX2(const int64_t* precios, const int32_t* stock, size_t n) {
+    const __m256i fuera = _mm256_set1_epi64x(static_cast<int64_t>(BITS_FUERA_DE_32));
+    __m256i total = _mm256_setzero_si256();
+    uint64_t resto = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(precios + i));
+        __m256i s = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(stock + i)));
+        if (!_mm256_testz_si256(_mm256_or_si256(p, s), fuera)) {
+            resto += valorarEscalar(precios + i, stock + i, 4);
+            continue;
+        }
+        total = _mm256_add_epi64(total, _mm256_mul_epu32(p, s));
+    }
+    uint64_t partes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(partes), total);
+    return partes[0] + partes[1] + partes[2] + partes[3] + resto +
+           valorarEscalar(precios + i, stock + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline void ajustarPreciosAVX2(int64_t* precios, size_t n, double factor) {
+    const __m256i exponente = _mm256_set1_epi64x(0x4330000000000000LL);
+    const __m256i fuera = _mm256_set1_epi64x(static_cast<int64_t>(BITS_FUERA_DE_51));
+    const __m256i mantisa = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m256d desplazamiento = _mm256_set1_pd(DOS_A_LA_52);
+    const __m256d multiplicador = _mm256_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(precios + i));
+        if (!_mm256_testz_si256(p, fuera)) {
+            ajustarPreciosEscalar(precios + i, 4, factor);
+            continue;
+        }
+        __m256d d = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(p, exponente)),
+                                  desplazamiento);
+        __m256d r = _mm256_add_pd(_mm256_mul_pd(d, multiplicador), desplazamiento);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(precios + i),
+                            _mm256_and_si256(_mm256_castpd_si256(r), mantisa));
+    }
+    ajustarPreciosEscalar(precios + i, n - i, factor);
+}
+#endif
+
+inline size_t buscarBajoUmbral(const int32_t* stock, size_t n, int32_t umbral,
+                               uint32_t* posiciones) {
+#if defined(INVENTARIO_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        return buscarBajoUmbralAVX2(stock, n, umbral, posiciones);
+    }
+#endif
+#if defined(INVENTARIO_SSE2)
+    return buscarBajoUmbralSSE2(stock, n, umbral, posiciones);
+#else
+    return buscarBajoUmbralEscalar(stock, n, umbral, posiciones);
+#endif
+}
+
+inline uint64_t valorarInventario(const int64_t* precios, const int32_t* stock, size_t n) {
+#if defined(INVENTARIO_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        return valorarAVX2(precios, stock, n);
+    }
+#endif
+#if defined(INVENTARIO_SSE2)
+    return valorarSSE2(precios, stock, n);
+#else
+    return valorarEscalar(precios, stock, n);
+#endif
+}
+
+// factor debe estar entre 0 y 2
+inline void ajustarPrecios(int64_t* precios, size_t n, double factor) {
+#if defined(INVENTARIO_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        ajustarPreciosAVX2(precios, n, factor);
+        return;
+    }
+#endif
+#if defined(INVENTARIO_SSE2)
+    ajustarPreciosSSE2(precios, n, factor);
+#else
+    ajustarPreciosEscalar(precios, n, factor);
+#endif
+}
+
 // ===== CLASE PRODUCTO =====
 class Producto {
 private:
     int codigo;
     string nombre;
-    double precio;
-    int stock;
+    Dinero precio;
+    // Atómico: varios hilos de cobro reservan del mismo producto a la vez.
+    // Solo importa el propio contador, así que basta el orden relaxed.
+    atomic<int> stock;
 
 public:
-    Producto(int cod, string nom, double prec, int stk)
+    Producto(int cod, string nom, Dinero prec, int stk)
         : codigo(cod), nombre(nom), precio(prec), stock(stk) {}
 
     int getCodigo() const { return codigo; }
     string getNombre() const { return nombre; }
-    double getPrecio() const { return precio; }
-    int getStock() const { return stock; }
+    Dinero getPrecio() const { return precio; }
+    int getStock() const { return stock.load(memory_order_relaxed); }
+    void setPrecio(Dinero prec) { precio = prec; }
 
-    // Método para reducir stock
+    // Método para reducir stock: compara e intercambia hasta que ningún
+    // otro hilo se haya adelantado, así el stock nunca queda negativo
     bool reducirStock(int cantidad) {
-        if (cantidad > stock) {
-            return false;
-        }
-        stock -= cantidad;
+        int actual = stock.load(memory_order_relaxed);
+        do {
+            if (cantidad > actual) {
+                return false;
+            }
+        } while (!stock.compare_exchange_weak(actual, actual - cantidad,
+                                              memory_order_relaxed, memory_order_relaxed));
         return true;
     }
 
     // Método para aumentar stock
     void aumentarStock(int cantidad) {
-        stock += cantidad;
+        stock.fetch_add(cantidad, memory_order_relaxed);
     }
 
     void mostrarInfo() const {
         cout << "[" << codigo << "] " << nombre 
-             << " - Precio: $" << fixed << setprecision(2) << precio
-             << " - Stock: " << stock << endl;
+             << " - Precio: $" << precio
+             << " - Stock: " << getStock() << endl;
     }
 };
 
+// ===== RESERVA DE STOCK =====
+struct LineaReserva {
+    shared_ptr<Producto> producto;
+    int cantidad;
+};
+
+// Reserva todas las líneas o ninguna: si una no tiene stock se devuelve lo
+// ya reservado de las anteriores. No usa cerrojos, así que dos reservas
+// que compiten no pueden bloquearse; a cambio, mientras una deshace, otra
+// puede ver el stock momentáneamente más bajo y fallar.
+bool reservarStock(const vector<LineaReserva>& lineas, size_t& fallida) {
+    for (size_t i = 0; i < lineas.size(); i++) {
+        if (!lineas[i].producto->reducirStock(lineas[i].cantidad)) {
+            fallida = i;
+            while (i > 0) {
+                i--;
+                lineas[i].producto->aumentarStock(lineas[i].cantidad);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 // ===== CLASE CLIENTE =====
 class Cliente {
 private:
@@ -94,9 +496,9 @@ public:
     string getEmail() const { return email; }
     TipoCliente getTipo() const { return tipo; }
 
-    // Método para calcular descuento según tipo
-    double getDescuento() const {
-        return (tipo == PREMIUM) ? 0.10 : 0.0; // 10% descuento para premium
+    // Método para calcular descuento según tipo (en tanto por ciento)
+    int getDescuento() const {
+        return (tipo == PREMIUM) ? 10 : 0; // 10% descuento para premium
     }
 
     void mostrarInfo() const {
@@ -107,57 +509,94 @@ public:
 };
 
 // ===== CLASE ITEMPEDIDO =====
+// El precio se copia al crear la línea: el subtotal no cambia aunque luego
+// cambie el precio del producto.
 class ItemPedido {
 private:
     shared_ptr<Producto> producto;
+    Dinero precio;
     int cantidad;
-    double subtotal;
+    Dinero subtotal;
 
 public:
     ItemPedido(shared_ptr<Producto> prod, int cant)
-        : producto(prod), cantidad(cant) {
-        subtotal = producto->getPrecio() * cantidad;
+        : producto(prod), precio(prod->getPrecio()), cantidad(0) {
+        setCantidad(cant);
     }
 
     shared_ptr<Producto> getProducto() const { return producto; }
     int getCantidad() const { return cantidad; }
-    double getSubtotal() const { return subtotal; }
+    Dinero getSubtotal() const { return subtotal; }
+
+    // Subtotal que tendría la línea con otra cantidad; false si no cabe
+    bool calcularSubtotal(int cant, Dinero& resultado) const {
+        resultado = precio;
+        return resultado.multiplicar(cant);
+    }
+
+    // Cambia la cantidad; false (sin cambios) si el subtotal no cabe
+    bool setCantidad(int cant) {
+        Dinero nuevo;
+        if (!calcularSubtotal(cant, nuevo)) {
+            return false;
+        }
+        cantidad = cant;
+        subtotal = nuevo;
+        return true;
+    }
 
     void mostrarInfo() const {
-        cout << "  " << producto->getNombre() 
-             << " x " << cantidad 
-             << " = $" << fixed << setprecision(2) << subtotal << endl;
+        cout << producto->getNombre()
+             << " x " << cantidad
+             << " = $" << subtotal << endl;
     }
 };
 
 // ===== CLASE PEDIDO =====
+// Subtotal, descuento y total se mantienen al día en cada cambio de línea
+// (agregar, eliminar o cambiar cantidad) sin volver a sumar las demás
+// líneas. Todo va en céntimos enteros, así no se acumula error por muchos
+// cambios que se hagan.
 class Pedido {
 private:
     int id;
-    string fecha;
+    MarcaTiempo marca; // Momento de creación; se formatea al mostrar el pedido
     shared_ptr<Cliente> cliente;
-    vector<shared_ptr<ItemPedido>> items;
-    double subtotal;
-    double descuento;
-    double total;
+    vector<ItemPedido> items; // Por valor: sin un objeto suelto por línea
+    Dinero subtotal;
+    Dinero descuento;
+    Dinero total;
     static int contadorPedidos;
 
+    // Descuento y total a partir del subtotal
+    void actualizarTotales() {
+        descuento = subtotal.porcentaje(cliente->getDescuento());
+        total = subtotal;
+        total.restar(descuento);
+    }
+
+    // Línea del pedido (empezando en 1) o nullptr
+    ItemPedido* buscarLinea(size_t linea) {
+        if (linea == 0 || linea > items.size()) {
+            cout << "Error: Línea de pedido no encontrada" << endl;
+            return nullptr;
+        }
+        return &items[linea - 1];
+    }
+
 public:
     Pedido(shared_ptr<Cliente> cli)
-        : cliente(cli), subtotal(0.0), descuento(0.0), total(0.0) {
+        : marca(marcaActual()), cliente(cli) {
         id = ++contadorPedidos;
-        // Obtener fecha actual
-        time_t ahora = time(0);
-        tm* tiempo = localtime(&ahora);
-        stringstream ss;
-        ss << put_time(tiempo, "%Y-%m-%d %H:%M:%S");
-        fecha = ss.str();
     }
 
     int getId() const { return id; }
-    string getFecha() const { return fecha; }
+    MarcaTiempo getMarca() const { return marca; }
+    string getFecha() const { return formatearMarca(marca); }
     shared_ptr<Cliente> getCliente() const { return cliente; }
-    double getTotal() const { return total; }
+    size_t getNumItems() const { return items.size(); }
+    Dinero getSubtotal() const { return subtotal; }
+    Dinero getTotal() const { return total; }
 
     // Método para agregar item al pedido
     bool agregarItem(shared_ptr<Producto> producto, int cantidad) {
@@ -166,38 +605,131 @@ public:
             return false;
         }
 
+        Dinero importeLinea = producto->getPrecio();
+        Dinero nuevoSubtotal = subtotal;
+        if (!importeLinea.multiplicar(cantidad) || !nuevoSubtotal.sumar(importeLinea)) {
+            cout << "Error: El total del pedido superaría el máximo permitido" << endl;
+            return false;
+        }
+
         if (!producto->reducirStock(cantidad)) {
             cout << "Error: Stock insuficiente para " << producto->getNombre() << endl;
             return false;
         }
 
-        items.push_back(make_shared<ItemPedido>(producto, cantidad));
-        recalcularTotal();
+        items.emplace_back(producto, cantidad);
+        subtotal = nuevoSubtotal;
+        actualizarTotales();
+        return true;
+    }
+
+    // Agrega varias líneas de una vez, sin mensajes: o se reservan todas o
+    // ninguna. Cada pedido lo modifica un solo hilo, pero varios hilos
+    // pueden reservar a la vez para pedidos distintos. Si algo falla,
+    // fallida indica la línea.
+    ResultadoReserva reservarItems(const vector<LineaReserva>& lineas, size_t& fallida) {
+        Dinero nuevoSubtotal = subtotal;
+        for (size_t i = 0; i < lineas.size(); i++) {
+            fallida = i;
+            if (lineas[i].cantidad <= 0) {
+                return CANTIDAD_INVALIDA;
+            }
+            Dinero importeLinea = lineas[i].producto->getPrecio();
+            if (!importeLinea.multiplicar(lineas[i].cantidad) || !nuevoSubtotal.sumar(importeLinea)) {
+                return TOTAL_EXCEDIDO;
+            }
+        }
+
+        if (!reservarStock(lineas, fallida)) {
+            return STOCK_INSUFICIENTE;
+        }
+
+        for (const auto& linea : lineas) {
+            items.emplace_back(linea.producto, linea.cantidad);
+        }
+        subtotal = nuevoSubtotal;
+        actualizarTotales();
+        return RESERVA_OK;
+    }
+
+    // Método para eliminar una línea del pedido (devuelve su stock). Las
+    // líneas que van detrás conservan su orden y bajan un número, así que
+    // se desplazan en el vector: cuesta O(n) en las líneas que quedan
+    // detrás (los totales sí se ajustan sin recorrer el pedido).
+    bool eliminarItem(size_t linea) {
+        ItemPedido* item = buscarLinea(linea);
+        if (!item) {
+            return false;
+        }
+        item->getProducto()->aumentarStock(item->getCantidad());
+        subtotal.restar(item->getSubtotal());
+        items.erase(items.begin() + static_cast<ptrdiff_t>(linea - 1));
+        actualizarTotales();
         return true;
     }
 
-    // Método para recalcular total
-    void recalcularTotal() {
-        subtotal = 0.0;
+    // Método para cambiar la cantidad de una línea; el stock se ajusta por
+    // la diferencia
+    bool cambiarCantidad(size_t linea, int cantidad) {
+        ItemPedido* item = buscarLinea(linea);
+        if (!item) {
+            return false;
+        }
+        if (cantidad <= 0) {
+            cout << "Error: La cantidad debe ser mayor a 0" << endl;
+            return false;
+        }
+
+        Dinero importeLinea;
+        Dinero nuevoSubtotal = subtotal;
+        nuevoSubtotal.restar(item->getSubtotal());
+        if (!item->calcularSubtotal(cantidad, importeLinea) ||
+            !nuevoSubtotal.sumar(importeLinea)) {
+            cout << "Error: El total del pedido superaría el máximo permitido" << endl;
+            return false;
+        }
+
+        auto producto = item->getProducto();
+        int diferencia = cantidad - item->getCantidad();
+        if (diferencia > 0 && !producto->reducirStock(diferencia)) {
+            cout << "Error: Stock insuficiente para " << producto->getNombre() << endl;
+            return false;
+        }
+        if (diferencia < 0) {
+            producto->aumentarStock(-diferencia);
+        }
+
+        item->setCantidad(cantidad);
+        subtotal = nuevoSubtotal;
+        actualizarTotales();
+        return true;
+    }
+
+    // Suma otra vez todas las líneas: sirve para comprobar que el subtotal
+    // llevado al día coincide
+    Dinero recalcularSubtotal() const {
+        Dinero suma;
         for (const auto& item : items) {
-            subtotal += item->getSubtotal();
+            suma.sumar(item.getSubtotal());
         }
-        descuento = subtotal * cliente->getDescuento();
-        total = subtotal - descuento;
+        return suma;
     }
 
     // Método para mostrar información del pedido
     void mostrarInfo() const {
         cout << "\n=== PEDIDO #" << id << " ===" << endl;
+        char fecha[LONGITUD_FECHA];
+        formatearMarca(marca, fecha);
         cout << "Fecha: " << fecha << endl;
         cliente->mostrarInfo();
         cout << "\nItems:" << endl;
-        for (const auto& item : items) {
-            item->mostrarInfo();
+        for (size_t i = 0; i < items.size(); i++) {
+            cout << "  " << (i + 1) << ". ";
+            items[i].mostrarInfo();
         }
-        cout << "\nSubtotal: $" << fixed << setprecision(2) << subtotal << endl;
-        if (descuento > 0) {
-            cout << "Descuento (" << (cliente->getDescuento() * 100) 
+        cout << "\nSubtotal: $" << subtotal << endl;
+        if (descuento > Dinero()) {
+            cout << "Descuento (" << cliente->getDescuento()
                  << "%): -$" << descuento << endl;
         }
         cout << "TOTAL: $" << total << endl;
@@ -207,6 +739,155 @@ public:
 // Inicializar contador estático
 int Pedido::contadorPedidos = 0;
 
+// ===== CLASE TABLAHASH =====
+// Índice de direccionamiento abierto (sondeo lineal) que asocia una clave
+// entera con la posición del objeto en su vector
+class TablaHash {
+private:
+    struct Ranura {
+        uint64_t clave;
+        int valor;
+        bool ocupada;
+    };
+
+    vector<Ranura> ranuras;
+    size_t ocupadas;
+
+    // Mezcla los bits de la clave (finalizador de splitmix64)
+    static uint64_t mezclar(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Cambia el número de ranuras (potencia de 2) y reinserta todas las claves
+    void crecer(size_t nuevaCapacidad) {
+        vector<Ranura> anteriores(nuevaCapacidad, Ranura{0, -1, false});
+        anteriores.swap(ranuras);
+        size_t mascara = ranuras.size() - 1;
+        for (const auto& r : anteriores) {
+            if (!r.ocupada) {
+                continue;
+            }
+            size_t i = mezclar(r.clave) & mascara;
+            while (ranuras[i].ocupada) {
+                i = (i + 1) & mascara;
+            }
+            ranuras[i] = r;
+        }
+    }
+
+public:
+    TablaHash() : ranuras(16, Ranura{0, -1, false}), ocupadas(0) {}
+
+    size_t size() const { return ocupadas; }
+
+    // Prepara la tabla para n claves sin volver a crecer (factor de carga <= 0.7)
+    void reservar(size_t n) {
+        size_t capacidad = ranuras.size();
+        while (n * 10 > capacidad * 7) {
+            capacidad *= 2;
+        }
+        if (capacidad != ranuras.size()) {
+            crecer(capacidad);
+        }
+    }
+
+    // Devuelve el valor asociado a la clave o -1 si no existe
+    int buscar(uint64_t clave) const {
+        size_t mascara = ranuras.size() - 1;
+        size_t i = mezclar(clave) & mascara;
+        while (ranuras[i].ocupada) {
+            if (ranuras[i].clave == clave) {
+                return ranuras[i].valor;
+            }
+            i = (i + 1) & mascara;
+        }
+        return -1;
+    }
+
+    // Inserta la clave; devuelve false si ya existía
+    bool insertar(uint64_t clave, int valor) {
+        reservar(ocupadas + 1);
+        size_t mascara = ranuras.size() - 1;
+        size_t i = mezclar(clave) & mascara;
+        while (ranuras[i].ocupada) {
+            if (ranuras[i].clave == clave) {
+                return false;
+            }
+            i = (i + 1) & mascara;
+        }
+        ranuras[i] = Ranura{clave, valor, true};
+        ocupadas++;
+        return true;
+    }
+};
+
+// ===== CLASE INVENTARIOCOLUMNAR =====
+// Códigos, precios (céntimos) y stock de un catálogo en vectores
+// contiguos, para las consultas masivas: "qué productos hay que reponer",
+// "cuánto vale el almacén" o "subir todos los precios" recorren memoria
+// seguida con SIMD en vez de saltar de un Producto a otro. Solo sirve
+// para esas consultas (medirInventario las compara con los objetos): el
+// stock de la tienda y sus reservas siguen en Producto.
+class InventarioColumnar {
+private:
+    vector<int32_t> codigos;
+    vector<int64_t> precios;
+    vector<int32_t> stock;
+
+public:
+    size_t size() const { return codigos.size(); }
+
+    void reservar(size_t n) {
+        codigos.reserve(n);
+        precios.reserve(n);
+        stock.reserve(n);
+    }
+
+    // Método para agregar un producto; false si el precio o el stock son
+    // negativos
+    bool agregar(int codigo, Dinero precio, int32_t cantidad) {
+        if (precio.getCentimos() < 0 || cantidad < 0) {
+            return false;
+        }
+        codigos.push_back(codigo);
+        precios.push_back(precio.getCentimos());
+        stock.push_back(cantidad);
+        return true;
+    }
+
+    int getCodigo(size_t pos) const { return codigos[pos]; }
+    Dinero getPrecio(size_t pos) const { return Dinero(precios[pos]); }
+
+    // Posiciones de los productos con stock por debajo del nivel de reposición
+    vector<uint32_t> bajoStock(int32_t umbral) const {
+        vector<uint32_t> posiciones(stock.size());
+        posiciones.resize(buscarBajoUmbral(stock.data(), stock.size(), umbral, posiciones.data()));
+        return posiciones;
+    }
+
+    // Valor del almacén (precio × stock); exacto mientras el valor real
+    // quepa en Dinero
+    Dinero valorar() const {
+        return Dinero(static_cast<int64_t>(valorarInventario(precios.data(), stock.data(),
+                                                             precios.size())));
+    }
+
+    // Multiplica todos los precios por factor (0.9 = rebaja del 10%),
+    // redondeando al céntimo; false si el factor no está entre 0 y 2
+    bool ajustarTodosLosPrecios(double factor) {
+        if (!(factor >= 0.0 && factor <= 2.0)) {
+            return false;
+        }
+        ajustarPrecios(precios.data(), precios.size(), factor);
+        return true;
+    }
+};
+
 // ===== CLASE TIENDA =====
 class Tienda {
 private:
@@ -214,39 +895,60 @@ private:
     vector<shared_ptr<Producto>> productos;
     vector<shared_ptr<Cliente>> clientes;
     vector<shared_ptr<Pedido>> pedidos;
+    TablaHash indiceProductos; // Código -> posición en productos
+    TablaHash indiceClientes;  // ID -> posición en clientes
+    // Los IDs de pedido son crecientes (Pedido::contadorPedidos): el ID
+    // menos el del primer pedido de la tienda es la posición en este
+    // vector, que guarda la posición del pedido en pedidos (-1 si el ID no
+    // es de esta tienda). Así no crece con los pedidos de otras tiendas
+    // anteriores.
+    vector<int32_t> indicePedidos;
+    int primerPedido; // ID de la posición 0 (vale con el índice vacío)
+
+    // Los códigos e IDs negativos también son claves válidas
+    static uint64_t clave(int valor) {
+        return static_cast<uint64_t>(static_cast<int64_t>(valor));
+    }
 
     // Métodos auxiliares
-    shared_ptr<Producto> buscarProducto(int codigo) {
-        for (auto& producto : productos) {
-            if (producto->getCodigo() == codigo) {
-                return producto;
-            }
-        }
-        return nullptr;
+    shared_ptr<Producto> buscarProducto(int codigo) const {
+        int pos = indiceProductos.buscar(clave(codigo));
+        return (pos < 0) ? nullptr : productos[pos];
     }
 
-    shared_ptr<Cliente> buscarCliente(int id) {
-        for (auto& cliente : clientes) {
-            if (cliente->getId() == id) {
-                return cliente;
-            }
+    shared_ptr<Cliente> buscarCliente(int id) const {
+        int pos = indiceClientes.buscar(clave(id));
+        return (pos < 0) ? nullptr : clientes[pos];
+    }
+
+    Pedido* buscarPedido(int id) const {
+        if (id < primerPedido ||
+            static_cast<size_t>(id - primerPedido) >= indicePedidos.size()) {
+            return nullptr;
         }
-        return nullptr;
+        int32_t pos = indicePedidos[id - primerPedido];
+        return (pos < 0) ? nullptr : pedidos[pos].get();
     }
 
 public:
-    Tienda(string nom) : nombre(nom) {}
+    Tienda(string nom) : nombre(nom), primerPedido(0) {}
 
     // Métodos para gestionar productos
     void agregarProducto(int codigo, string nombre, double precio, int stock) {
-        if (buscarProducto(codigo)) {
+        if (!indiceProductos.insertar(clave(codigo), static_cast<int>(productos.size()))) {
             cout << "Error: Producto ya existe" << endl;
             return;
         }
-        productos.push_back(make_shared<Producto>(codigo, nombre, precio, stock));
+        productos.push_back(make_shared<Producto>(codigo, nombre, Dinero::importe(precio), stock));
         cout << "Producto agregado: " << nombre << endl;
     }
 
+    // Stock de un producto o -1 si no existe
+    int getStockProducto(int codigo) const {
+        auto producto = buscarProducto(codigo);
+        return producto ? producto->getStock() : -1;
+    }
+
     void mostrarProductos() const {
         cout << "\n=== CATÁLOGO DE PRODUCTOS ===" << endl;
         for (const auto& producto : productos) {
@@ -256,7 +958,7 @@ public:
 
     // Métodos para gestionar clientes
     void registrarCliente(int id, string nombre, string email, TipoCliente tipo) {
-        if (buscarCliente(id)) {
+        if (!indiceClientes.insertar(clave(id), static_cast<int>(clientes.size()))) {
             cout << "Error: Cliente ya registrado" << endl;
             return;
         }
@@ -272,29 +974,48 @@ public:
         }
     }
 
-    // Método para crear pedido
-    shared_ptr<Pedido> crearPedido(int clienteId) {
+    // Crea un pedido sin mensajes; nullptr si el cliente no existe
+    shared_ptr<Pedido> intentarCrearPedido(int clienteId) {
         auto cliente = buscarCliente(clienteId);
         if (!cliente) {
-            cout << "Error: Cliente no encontrado" << endl;
             return nullptr;
         }
 
         auto pedido = make_shared<Pedido>(cliente);
+        if (indicePedidos.empty()) {
+            primerPedido = pedido->getId();
+        }
+        size_t posicion = static_cast<size_t>(pedido->getId() - primerPedido);
+        if (posicion >= indicePedidos.size()) {
+            indicePedidos.resize(max(posicion + 1, indicePedidos.size() * 2), -1);
+        }
+        indicePedidos[posicion] = static_cast<int32_t>(pedidos.size());
         pedidos.push_back(pedido);
-        cout << "Pedido #" << pedido->getId() << " creado para " 
-             << cliente->getNombre() << endl;
+        return pedido;
+    }
+
+    // Líneas de un pedido o -1 si no existe
+    int getNumItemsPedido(int pedidoId) const {
+        auto pedido = buscarPedido(pedidoId);
+        return pedido ? static_cast<int>(pedido->getNumItems()) : -1;
+    }
+
+    // Método para crear pedido
+    shared_ptr<Pedido> crearPedido(int clienteId) {
+        auto pedido = intentarCrearPedido(clienteId);
+        if (!pedido) {
+            cout << "Error: Cliente no encontrado" << endl;
+            return nullptr;
+        }
+        cout << "Pedido #" << pedido->getId() << " creado para "
+             << pedido->getCliente()->getNombre() << endl;
         return pedido;
     }
 
     // Método para agregar item a pedido
     bool agregarItemAPedido(int pedidoId, int codigoProducto, int cantidad) {
-        auto pedido = find_if(pedidos.begin(), pedidos.end(),
-            [pedidoId](const shared_ptr<Pedido>& p) {
-                return p->getId() == pedidoId;
-            });
-
-        if (pedido == pedidos.end()) {
+        auto pedido = buscarPedido(pedidoId);
+        if (!pedido) {
             cout << "Error: Pedido no encontrado" << endl;
             return false;
         }
@@ -305,22 +1026,88 @@ public:
             return false;
         }
 
-        return (*pedido)->agregarItem(producto, cantidad);
+        return pedido->agregarItem(producto, cantidad);
+    }
+
+    // Reserva varias líneas (código, cantidad) en un pedido, sin mensajes.
+    // Puede llamarse desde varios hilos a la vez para pedidos distintos,
+    // siempre que mientras tanto no se den de alta productos, clientes ni
+    // pedidos.
+    ResultadoReserva reservarEnPedido(int pedidoId, const vector<pair<int, int>>& lineas,
+                                      size_t& fallida) {
+        Pedido* pedido = buscarPedido(pedidoId);
+        if (!pedido) {
+            return PEDIDO_NO_ENCONTRADO;
+        }
+        vector<LineaReserva> reserva;
+        reserva.reserve(lineas.size());
+        for (size_t i = 0; i < lineas.size(); i++) {
+            auto producto = buscarProducto(lineas[i].first);
+            if (!producto) {
+                fallida = i;
+                return PRODUCTO_NO_ENCONTRADO;
+            }
+            reserva.push_back(LineaReserva{producto, lineas[i].second});
+        }
+        return pedido->reservarItems(reserva, fallida);
+    }
+
+    // Método para agregar varias líneas a un pedido (todas o ninguna)
+    bool agregarItemsAPedido(int pedidoId, const vector<pair<int, int>>& lineas) {
+        size_t fallida = 0;
+        switch (reservarEnPedido(pedidoId, lineas, fallida)) {
+            case RESERVA_OK:
+                return true;
+            case PEDIDO_NO_ENCONTRADO:
+                cout << "Error: Pedido no encontrado" << endl;
+                break;
+            case PRODUCTO_NO_ENCONTRADO:
+                cout << "Error: Producto no encontrado" << endl;
+                break;
+            case CANTIDAD_INVALIDA:
+                cout << "Error: La cantidad debe ser mayor a 0" << endl;
+                break;
+            case TOTAL_EXCEDIDO:
+                cout << "Error: El total del pedido superaría el máximo permitido" << endl;
+                break;
+            case STOCK_INSUFICIENTE:
+                cout << "Error: Stock insuficiente para "
+                     << buscarProducto(lineas[fallida].first)->getNombre()
+                     << " (no se reservó ninguna línea)" << endl;
+                break;
+        }
+        return false;
+    }
+
+    // Método para eliminar una línea de un pedido
+    bool eliminarItemDePedido(int pedidoId, size_t linea) {
+        auto pedido = buscarPedido(pedidoId);
+        if (!pedido) {
+            cout << "Error: Pedido no encontrado" << endl;
+            return false;
+        }
+        return pedido->eliminarItem(linea);
+    }
+
+    // Método para cambiar la cantidad de una línea de un pedido
+    bool cambiarCantidadEnPedido(int pedidoId, size_t linea, int cantidad) {
+        auto pedido = buscarPedido(pedidoId);
+        if (!pedido) {
+            cout << "Error: Pedido no encontrado" << endl;
+            return false;
+        }
+        return pedido->cambiarCantidad(linea, cantidad);
     }
 
     // Método para mostrar pedido
     void mostrarPedido(int pedidoId) {
-        auto pedido = find_if(pedidos.begin(), pedidos.end(),
-            [pedidoId](const shared_ptr<Pedido>& p) {
-                return p->getId() == pedidoId;
-            });
-
-        if (pedido == pedidos.end()) {
+        auto pedido = buscarPedido(pedidoId);
+        if (!pedido) {
             cout << "Error: Pedido no encontrado" << endl;
             return;
         }
 
-        (*pedido)->mostrarInfo();
+        pedido->mostrarInfo();
     }
 
     // Método para mostrar todos los pedidos
@@ -336,15 +1123,321 @@ public:
     }
 
     // Método para calcular ventas totales
-    double calcularVentasTotales() const {
-        double total = 0.0;
+    Dinero calcularVentasTotales() const {
+        Dinero total;
         for (const auto& pedido : pedidos) {
-            total += pedido->getTotal();
+            total.sumar(pedido->getTotal());
         }
         return total;
     }
 };
 
+// ===== PEDIDOS GRANDES =====
+// Construye un pedido de muchas líneas, cambia todas las cantidades y
+// elimina la mitad de las líneas, con totales incrementales. Se elimina
+// siempre la primera línea, el peor caso: las demás conservan su orden y
+// se desplazan en el vector, así que esta parte crece con el cuadrado de
+// las líneas. Como referencia, mide también volver a sumar todo el pedido
+// en cada línea agregada (lo que se hacía antes), que también crece con el
+// cuadrado de las líneas.
+void medirPedidoGrande(int lineas) {
+    auto cliente = make_shared<Cliente>(900, "Mayorista", "compras@mayorista.com", PREMIUM);
+    vector<shared_ptr<Producto>> catalogo;
+    for (int i = 0; i < 100; i++) {
+        catalogo.push_back(make_shared<Producto>(1000 + i, "Artículo " + to_string(i),
+                                                 Dinero(199 + i * 37), 1000000000));
+    }
+
+    Pedido pedido(cliente);
+    auto inicio = chrono::steady_clock::now();
+    for (int i = 0; i < lineas; i++) {
+        pedido.agregarItem(catalogo[i % catalogo.size()], 1 + i % 7);
+    }
+    auto agregado = chrono::steady_clock::now();
+    for (int i = 0; i < lineas; i++) {
+        pedido.cambiarCantidad(static_cast<size_t>(i) + 1, 2 + i % 5);
+    }
+    auto cambiado = chrono::steady_clock::now();
+    for (int i = 0; i < lineas / 2; i++) {
+        pedido.eliminarItem(1);
+    }
+    auto fin = chrono::steady_clock::now();
+
+    Pedido referencia(cliente);
+    Dinero suma;
+    auto inicioReferencia = chrono::steady_clock::now();
+    for (int i = 0; i < lineas; i++) {
+        referencia.agregarItem(catalogo[i % catalogo.size()], 1 + i % 7);
+        suma = referencia.recalcularSubtotal();
+    }
+    auto finReferencia = chrono::steady_clock::now();
+
+    auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count();
+    };
+    cout << "Líneas: " << lineas << fixed << setprecision(2)
+         << " - Agregar: " << ms(inicio, agregado) << " ms"
+         << " - Cambiar: " << ms(agregado, cambiado) << " ms"
+         << " - Eliminar la mitad (desde la primera, desplazando las demás): " << ms(cambiado, fin)
+         << " ms"
+         << " - Sumando todo en cada línea: " << ms(inicioReferencia, finReferencia) << " ms"
+         << endl;
+    cout << "Quedan " << pedido.getNumItems() << " líneas - Subtotal: $" << pedido.getSubtotal()
+         << " - Total: $" << pedido.getTotal()
+         << (pedido.getSubtotal() == pedido.recalcularSubtotal() && suma == referencia.getSubtotal()
+                 ? " (coincide con la suma de las líneas)" : " (ERROR)")
+         << endl;
+}
+
+// ===== BÚSQUEDAS CON MUCHOS PEDIDOS =====
+// Mide por separado buscar un pedido al azar, buscar el producto y agregar
+// una línea a medida que la tienda acumula pedidos. Con los índices, las
+// búsquedas hacen el mismo trabajo con cualquier número de pedidos; lo que
+// sube el tiempo es que los pedidos elegidos están repartidos por más
+// memoria (más fallos de caché). Agregar, además, hace crecer los vectores
+// de líneas con cada muestra.
+void medirBusquedas(Tienda& tienda, int clienteId, int codigoProducto) {
+    mt19937 azar(5);
+    vector<int> ids;
+    const int MUESTRAS = 20000;
+    for (int objetivo : {1000, 10000, 100000, 500000}) {
+        while (static_cast<int>(ids.size()) < objetivo) {
+            ids.push_back(tienda.intentarCrearPedido(clienteId)->getId());
+        }
+        uniform_int_distribution<size_t> elegir(0, ids.size() - 1);
+        vector<int> muestra(MUESTRAS);
+        for (int& id : muestra) {
+            id = ids[elegir(azar)];
+        }
+        auto ns = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+            return chrono::duration<double, nano>(b - a).count() / MUESTRAS;
+        };
+        long long comprobacion = 0; // Para que las búsquedas no se eliminen
+        auto inicio = chrono::steady_clock::now();
+        for (int id : muestra) {
+            comprobacion += tienda.getNumItemsPedido(id);
+        }
+        auto pedidosBuscados = chrono::steady_clock::now();
+        for (int i = 0; i < MUESTRAS; i++) {
+            comprobacion += tienda.getStockProducto(codigoProducto) > 0;
+        }
+        auto productosBuscados = chrono::steady_clock::now();
+        for (int id : muestra) {
+            tienda.agregarItemAPedido(id, codigoProducto, 1);
+        }
+        auto fin = chrono::steady_clock::now();
+        cout << "Pedidos: " << objetivo << fixed << setprecision(0)
+             << " - Buscar pedido: " << ns(inicio, pedidosBuscados) << " ns"
+             << " - Buscar producto: " << ns(pedidosBuscados, productosBuscados) << " ns"
+             << " - Agregar línea: " << ns(productosBuscados, fin) << " ns"
+             << (comprobacion < 0 ? " (ERROR)" : "") << endl;
+    }
+}
+
+// ===== PRODUCTO MUY DISPUTADO =====
+// Varios hilos reservan y devuelven sin parar una cesta con el mismo
+// producto "caliente" y otro propio de cada hilo: mide cuánto cuesta la
+// competencia por un único contador de stock.
+void medirProductoDisputado(int operaciones) {
+    for (int hilos : {1, 2, 4, 8}) {
+        auto caliente = make_shared<Producto>(600, "Consola", Dinero(49999), 1000000000);
+        vector<thread> trabajadores;
+        auto inicio = chrono::steady_clock::now();
+        for (int h = 0; h < hilos; h++) {
+            trabajadores.emplace_back([&caliente, h, hilos, operaciones]() {
+                vector<LineaReserva> cesta;
+                cesta.push_back(LineaReserva{caliente, 1});
+                cesta.push_back(LineaReserva{make_shared<Producto>(601 + h, "Mando", Dinero(5999), 1000000000), 2});
+                size_t fallida = 0;
+                for (int i = 0; i < operaciones / hilos; i++) {
+                    if (reservarStock(cesta, fallida)) {
+                        for (const auto& linea : cesta) {
+                            linea.producto->aumentarStock(linea.cantidad);
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& t : trabajadores) {
+            t.join();
+        }
+        double s = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        cout << "Hilos: " << hilos << " - Reserva y devolución: " << fixed << setprecision(1)
+             << operaciones / s / 1e6 << " M/s"
+             << (caliente->getStock() == 1000000000 ? " (stock intacto)" : " (ERROR)") << endl;
+    }
+}
+
+// ===== VENTA RELÁMPAGO =====
+// Muchos hilos cobran a la vez cestas de tres líneas que comparten un
+// producto con poco stock. Al terminar, para cada producto lo vendido
+// según los pedidos aceptados debe coincidir con lo que bajó el stock
+// (una reserva a medias lo descuadraría) y el stock no debe haber bajado
+// nunca de 0.
+void simularVentaRelampago(int hilos, int cestasPorHilo) {
+    Tienda tienda("Venta Relámpago");
+    const int CALIENTE = 701;
+    const vector<int> codigos = {701, 702, 703, 704, 705};
+    const vector<int> iniciales = {5000, 20000, 20000, 20000, 20000};
+    cout.setstate(ios::failbit); // Sin los mensajes de alta
+    for (size_t p = 0; p < codigos.size(); p++) {
+        tienda.agregarProducto(codigos[p], "Oferta " + to_string(p), 9.99 + p, iniciales[p]);
+    }
+    tienda.registrarCliente(70, "Comprador", "comprador@email.com", REGULAR);
+    cout.clear();
+    vector<int> pedidos;
+    for (int i = 0; i < hilos * cestasPorHilo; i++) {
+        pedidos.push_back(tienda.intentarCrearPedido(70)->getId());
+    }
+
+    vector<vector<long long>> vendidos(hilos, vector<long long>(codigos.size(), 0));
+    vector<int> aceptadas(hilos, 0);
+    vector<int> minimoVisto(hilos, INT32_MAX);
+    vector<thread> cajas;
+    auto inicio = chrono::steady_clock::now();
+    for (int h = 0; h < hilos; h++) {
+        cajas.emplace_back([&, h]() {
+            mt19937 azar(static_cast<unsigned>(h) + 1);
+            for (int i = 0; i < cestasPorHilo; i++) {
+                size_t a = 1 + azar() % 4;
+                size_t b = 1 + (a + azar() % 3) % 4;
+                vector<pair<int, int>> cesta = {
+                    {codigos[0], 1 + static_cast<int>(azar() % 3)},
+                    {codigos[a], 1 + static_cast<int>(azar() % 4)},
+                    {codigos[b], 1 + static_cast<int>(azar() % 4)}};
+                size_t fallida = 0;
+                if (tienda.reservarEnPedido(pedidos[h * cestasPorHilo + i], cesta, fallida) == RESERVA_OK) {
+                    aceptadas[h]++;
+                    vendidos[h][0] += cesta[0].second;
+                    vendidos[h][a] += cesta[1].second;
+                    vendidos[h][b] += cesta[2].second;
+                }
+                minimoVisto[h] = min(minimoVisto[h], tienda.getStockProducto(CALIENTE));
+            }
+        });
+    }
+    for (auto& c : cajas) {
+        c.join();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+
+    bool cuadra = true;
+    int totalAceptadas = 0;
+    int minimo = INT32_MAX;
+    for (int h = 0; h < hilos; h++) {
+        totalAceptadas += aceptadas[h];
+        minimo = min(minimo, minimoVisto[h]);
+    }
+    for (size_t p = 0; p < codigos.size(); p++) {
+        long long vendido = 0;
+        for (int h = 0; h < hilos; h++) {
+            vendido += vendidos[h][p];
+        }
+        int stock = tienda.getStockProducto(codigos[p]);
+        cuadra = cuadra && stock >= 0 && iniciales[p] - stock == vendido;
+    }
+    cout << "Cajas: " << hilos << " - Cestas: " << hilos * cestasPorHilo
+         << " - Aceptadas: " << totalAceptadas << " en " << fixed << setprecision(1) << ms << " ms"
+         << endl;
+    cout << "Stock final de la oferta: " << tienda.getStockProducto(CALIENTE)
+         << " - Mínimo visto: " << minimo
+         << (cuadra && minimo >= 0 ? " (stock nunca negativo, vendido = stock descontado)"
+                                   : " (ERROR)")
+         << endl;
+    cout << "Ventas: $" << tienda.calcularVentasTotales() << endl;
+}
+
+// ===== INVENTARIO DE UN MILLÓN DE PRODUCTOS =====
+// Compara las consultas masivas sobre el catálogo de objetos (un Producto
+// por producto, como Tienda::productos) con las mismas consultas sobre el
+// inventario por columnas, y comprueba que dan lo mismo.
+void medirInventario(size_t n) {
+    mt19937 azar(11);
+    vector<shared_ptr<Producto>> objetos;
+    objetos.reserve(n);
+    InventarioColumnar columnas;
+    columnas.reservar(n);
+    for (size_t i = 0; i < n; i++) {
+        int codigo = 100000 + static_cast<int>(i);
+        Dinero precio(99 + static_cast<int64_t>(azar() % 100000));
+        int cantidad = static_cast<int>(azar() % 500);
+        objetos.push_back(make_shared<Producto>(codigo, "SKU " + to_string(i), precio, cantidad));
+        columnas.agregar(codigo, precio, cantidad);
+    }
+
+    const int REPETICIONES = 10;
+    const int32_t UMBRAL = 20;
+    const double factores[2] = {1.1, 0.9};
+    auto ms = [REPETICIONES](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count() / REPETICIONES;
+    };
+
+    // Catálogo de objetos
+    vector<int> reponerObjetos;
+    Dinero valorObjetos;
+    auto inicio = chrono::steady_clock::now();
+    for (int r = 0; r < REPETICIONES; r++) {
+        reponerObjetos.clear();
+        for (const auto& producto : objetos) {
+            if (producto->getStock() < UMBRAL) {
+                reponerObjetos.push_back(producto->getCodigo());
+            }
+        }
+    }
+    auto escaneado = chrono::steady_clock::now();
+    for (int r = 0; r < REPETICIONES; r++) {
+        int64_t total = 0;
+        for (const auto& producto : objetos) {
+            total += producto->getPrecio().getCentimos() * producto->getStock();
+        }
+        valorObjetos = Dinero(total);
+    }
+    auto valorado = chrono::steady_clock::now();
+    for (int r = 0; r < REPETICIONES; r++) {
+        for (const auto& producto : objetos) {
+            double nuevo = static_cast<double>(producto->getPrecio().getCentimos()) * factores[r % 2];
+            producto->setPrecio(Dinero(static_cast<int64_t>(nearbyint(nuevo))));
+        }
+    }
+    auto ajustado = chrono::steady_clock::now();
+
+    // Inventario por columnas
+    vector<uint32_t> reponerColumnas;
+    Dinero valorColumnas;
+    auto inicioColumnas = chrono::steady_clock::now();
+    for (int r = 0; r < REPETICIONES; r++) {
+        reponerColumnas = columnas.bajoStock(UMBRAL);
+    }
+    auto escaneadoColumnas = chrono::steady_clock::now();
+    for (int r = 0; r < REPETICIONES; r++) {
+        valorColumnas = columnas.valorar();
+    }
+    auto valoradoColumnas = chrono::steady_clock::now();
+    for (int r = 0; r < REPETICIONES; r++) {
+        columnas.ajustarTodosLosPrecios(factores[r % 2]);
+    }
+    auto ajustadoColumnas = chrono::steady_clock::now();
+
+    bool coincide = reponerObjetos.size() == reponerColumnas.size() && valorObjetos == valorColumnas;
+    for (size_t i = 0; coincide && i < reponerColumnas.size(); i++) {
+        coincide = columnas.getCodigo(reponerColumnas[i]) == reponerObjetos[i];
+    }
+    for (size_t i = 0; coincide && i < n; i++) {
+        coincide = columnas.getPrecio(i) == objetos[i]->getPrecio();
+    }
+
+    cout << "Productos: " << n << " - Objetos / columnas (ms por consulta)" << endl;
+    cout << fixed << setprecision(2)
+         << "  Bajo stock (" << reponerColumnas.size() << "): " << ms(inicio, escaneado)
+         << " / " << ms(inicioColumnas, escaneadoColumnas) << endl
+         << "  Valor del almacén ($" << valorColumnas << "): " << ms(escaneado, valorado)
+         << " / " << ms(escaneadoColumnas, valoradoColumnas) << endl
+         << "  Ajuste de precios: " << ms(valorado, ajustado)
+         << " / " << ms(valoradoColumnas, ajustadoColumnas) << endl;
+    cout << (coincide ? "Mismos resultados en los dos formatos" : "ERROR: los formatos no coinciden")
+         << endl;
+}
+
 // ===== FUNCIÓN MAIN - DEMOSTRACIÓN =====
 int main() {
     // Crear tienda
@@ -380,6 +1473,13 @@ int main() {
     tienda.agregarItemAPedido(2, 104, 2); // Monitor x2 (cliente premium con descuento)
     tienda.agregarItemAPedido(2, 102, 1); // Mouse
 
+    // Modificar líneas: los totales se ajustan sin volver a sumar el pedido
+    cout << "\n=== MODIFICANDO PEDIDOS ===" << endl;
+    tienda.cambiarCantidadEnPedido(1, 2, 3);   // Mouse x3
+    tienda.eliminarItemDePedido(1, 3);         // Fuera el teclado
+    tienda.cambiarCantidadEnPedido(2, 1, 100); // Stock insuficiente
+    tienda.eliminarItemDePedido(2, 7);         // Línea inexistente
+
     // Mostrar pedidos
     tienda.mostrarPedido(1);
     tienda.mostrarPedido(2);
@@ -390,8 +1490,44 @@ int main() {
 
     // Mostrar ventas totales
     cout << "\n=== RESUMEN DE VENTAS ===" << endl;
-    cout << "Ventas totales: $" << fixed << setprecision(2) 
-         << tienda.calcularVentasTotales() << endl;
+    cout << "Ventas totales: $" << tienda.calcularVentasTotales() << endl;
+
+    // Reserva de varias líneas: todas o ninguna
+    cout << "\n=== RESERVA DE VARIAS LÍNEAS ===" << endl;
+    auto pedido3 = tienda.crearPedido(2);
+    tienda.agregarItemsAPedido(pedido3->getId(), {{101, 1}, {103, 2}, {104, 100}}); // Falla el monitor
+    cout << "Stock tras la reserva fallida - Laptop: " << tienda.getStockProducto(101)
+         << ", Teclado: " << tienda.getStockProducto(103) << endl;
+    tienda.agregarItemsAPedido(pedido3->getId(), {{101, 1}, {103, 2}, {104, 1}});
+    tienda.mostrarPedido(pedido3->getId());
+
+    // Tienda con cientos de miles de pedidos
+    cout << "\n=== BÚSQUEDAS CON MUCHOS PEDIDOS ===" << endl;
+    {
+        Tienda central("Tienda Central");
+        central.agregarProducto(501, "Cable USB", 4.99, 1000000000);
+        central.registrarCliente(50, "Distribuciones Sur", "pedidos@sur.com", REGULAR);
+        medirBusquedas(central, 50, 501);
+        cout << "(Las búsquedas no recorren los pedidos: lo que sube son los fallos de caché"
+             << " al tocar pedidos dispersos; agregar incluye buscar y el crecimiento de las"
+             << " líneas)" << endl;
+    }
+
+    // Competencia por un mismo producto
+    cout << "\n=== PRODUCTO MUY DISPUTADO ===" << endl;
+    medirProductoDisputado(2000000);
+
+    // Muchas cajas cobrando a la vez
+    cout << "\n=== VENTA RELÁMPAGO ===" << endl;
+    simularVentaRelampago(8, 2000);
+
+    // Consultas masivas sobre un inventario grande
+    cout << "\n=== INVENTARIO DE UN MILLÓN DE PRODUCTOS ===" << endl;
+    medirInventario(1000000);
+
+    // Pedido mayorista de 10.000 líneas
+    cout << "\n=== PEDIDO DE 10.000 LÍNEAS ===" << endl;
+    medirPedidoGrande(10000);
 
     return 0;
 }